@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: gate-level cell library.
+ *
+ * These are the cells that the generated netlist of the gates
+ * benchmark is made of. The storage and multiplexer cells are built
+ * around user defined primitives, as in a typical vendor library, and
+ * all the cells have specify paths that the generated SDF file
+ * annotates. The netlist must be compiled with -gspecify.
+ */
+
+`timescale 1ns/10ps
+
+primitive udp_mux2 (y, a, b, s);
+   output y;
+   input  a, b, s;
+   table
+   // a b s : y
+      0 ? 0 : 0 ;
+      1 ? 0 : 1 ;
+      ? 0 1 : 0 ;
+      ? 1 1 : 1 ;
+      0 0 ? : 0 ;
+      1 1 ? : 1 ;
+   endtable
+endprimitive
+
+primitive udp_dff (q, d, ck);
+   output q;
+   reg    q;
+   input  d, ck;
+   initial q = 1'b0;
+   table
+   // d  ck   : q : q+
+      0 (01)  : ? : 0 ;
+      1 (01)  : ? : 1 ;
+      0 (0x)  : 0 : 0 ;
+      1 (0x)  : 1 : 1 ;
+      ? (?0)  : ? : - ;
+      ? (1x)  : ? : - ;
+      * ?     : ? : - ;
+   endtable
+endprimitive
+
+`celldefine
+module INV (Y, A);
+   output Y;
+   input  A;
+   not u0 (Y, A);
+   specify
+      (A => Y) = (1, 1);
+   endspecify
+endmodule
+`endcelldefine
+
+`celldefine
+module XOR2 (Y, A, B);
+   output Y;
+   input  A, B;
+   xor u0 (Y, A, B);
+   specify
+      (A => Y) = (1, 1);
+      (B => Y) = (1, 1);
+   endspecify
+endmodule
+`endcelldefine
+
+`celldefine
+module MUX2 (Y, A, B, S);
+   output Y;
+   input  A, B, S;
+   udp_mux2 u0 (Y, A, B, S);
+   specify
+      (A => Y) = (1, 1);
+      (B => Y) = (1, 1);
+      (S => Y) = (1, 1);
+   endspecify
+endmodule
+`endcelldefine
+
+`celldefine
+module DFF (Q, D, CK);
+   output Q;
+   input  D, CK;
+   udp_dff u0 (Q, D, CK);
+   specify
+      (posedge CK => (Q +: D)) = (2, 2);
+   endspecify
+endmodule
+`endcelldefine
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: SystemVerilog class and queue heavy test bench.
+ *
+ * Each round allocates a pool of packet objects into a dynamic array,
+ * queues their indices, then drains the queue computing a checksum of
+ * each packet and linking the packets into a list through a class
+ * handle property. The list is then walked and the pool is released.
+ * This exercises object allocation and release, class properties and
+ * methods, dynamic arrays and queues. Compile with -g2012.
+ */
+
+class packet;
+   int id;
+   int len;
+   bit [31:0] crc;
+   packet next;
+
+   function new(int id, int len);
+      this.id = id;
+      this.len = len;
+      crc = 0;
+      next = null;
+   endfunction
+
+   function void compute();
+      int idx;
+      bit fb;
+      crc = 32'hffffffff;
+      for (idx = 0 ; idx < len ; idx = idx + 1) begin
+	 fb = crc[31] ^ id[idx % 32];
+	 crc = {crc[30:0], 1'b0};
+	 if (fb)
+	   crc = crc ^ 32'h04c11db7;
+      end
+   endfunction
+endclass
+
+module bench_classes;
+
+   localparam POOL = 256;
+
+   packet pool[];
+   int fifo[$];
+   packet head, cur;
+   int rounds, round, idx, slot;
+   bit [31:0] total;
+
+   initial begin
+      if (!$value$plusargs("rounds=%d", rounds))
+	rounds = 400;
+
+      total = 0;
+      for (round = 0 ; round < rounds ; round = round + 1) begin
+	 pool = new[POOL];
+	 for (idx = 0 ; idx < POOL ; idx = idx + 1) begin
+	    pool[idx] = new(round*POOL + idx, 16 + idx%16);
+	    fifo.push_back(idx);
+	 end
+
+	 head = null;
+	 while (fifo.size() > 0) begin
+	    slot = fifo.pop_front();
+	    cur = pool[slot];
+	    cur.compute();
+	    cur.next = head;
+	    head = cur;
+	 end
+
+	 while (head != null) begin
+	    total = total + head.crc;
+	    cur = head;
+	    head = head.next;
+	    cur.next = null;
+	 end
+
+	 pool.delete();
+      end
+
+      $display("classes: total=%h", total);
+      $finish;
+   end
+
+endmodule
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: RTL processor core.
+ *
+ * A small 16-register, 32-bit load/store machine with a combinational
+ * ALU, a register file and data memory in arrays, and a clocked
+ * control path. The test bench loads a program that repeatedly runs a
+ * multiply/accumulate/shift loop over the data memory, then waits for
+ * the core to halt. This exercises clocked always blocks, case
+ * decoding, array reads and writes and nonblocking assignments.
+ */
+
+`timescale 1ns/1ps
+
+module cpu(input wire clk, input wire rst,
+	   output reg halted, output wire [31:0] result);
+
+   localparam OP_LI   = 4'h0;
+   localparam OP_ADD  = 4'h1;
+   localparam OP_SUB  = 4'h2;
+   localparam OP_AND  = 4'h3;
+   localparam OP_OR   = 4'h4;
+   localparam OP_XOR  = 4'h5;
+   localparam OP_SHL  = 4'h6;
+   localparam OP_SHR  = 4'h7;
+   localparam OP_LD   = 4'h8;
+   localparam OP_ST   = 4'h9;
+   localparam OP_BNZ  = 4'ha;
+   localparam OP_ADDI = 4'hb;
+   localparam OP_MUL  = 4'hc;
+   localparam OP_HALT = 4'hf;
+
+   reg [15:0] imem [0:255];
+   reg [31:0] dmem [0:1023];
+   reg [31:0] regs [0:15];
+   reg [7:0]  pc;
+
+   wire [15:0] ir  = imem[pc];
+   wire [3:0]  op  = ir[15:12];
+   wire [3:0]  rd  = ir[11:8];
+   wire [3:0]  rs  = ir[7:4];
+   wire [3:0]  rt  = ir[3:0];
+   wire [7:0]  imm = ir[7:0];
+   wire [31:0] a   = regs[rs];
+   wire [31:0] b   = regs[rt];
+   wire [31:0] d   = regs[rd];
+
+   reg [31:0] alu;
+   always @* begin
+      case (op)
+	OP_LI:   alu = {24'd0, imm};
+	OP_ADD:  alu = a + b;
+	OP_SUB:  alu = a - b;
+	OP_AND:  alu = a & b;
+	OP_OR:   alu = a | b;
+	OP_XOR:  alu = a ^ b;
+	OP_SHL:  alu = a << b[4:0];
+	OP_SHR:  alu = a >> b[4:0];
+	OP_ADDI: alu = d + {{24{imm[7]}}, imm};
+	OP_MUL:  alu = a * b;
+	default: alu = 32'd0;
+      endcase
+   end
+
+   integer idx;
+   always @(posedge clk) begin
+      if (rst) begin
+	 pc <= 8'd0;
+	 halted <= 1'b0;
+	 for (idx = 0 ; idx < 16 ; idx = idx + 1)
+	   regs[idx] <= 32'd0;
+      end else if (!halted) begin
+	 pc <= pc + 8'd1;
+	 case (op)
+	   OP_LD:   regs[rd] <= dmem[a[9:0]];
+	   OP_ST:   dmem[a[9:0]] <= b;
+	   OP_BNZ:  if (d != 32'd0) pc <= imm;
+	   OP_HALT: halted <= 1'b1;
+	   default: regs[rd] <= alu;
+	 endcase
+      end
+   end
+
+   assign result = regs[6];
+
+endmodule
+
+module bench_cpu;
+
+   reg clk = 1'b0;
+   reg rst = 1'b1;
+   wire halted;
+   wire [31:0] result;
+
+   cpu u_cpu(.clk(clk), .rst(rst), .halted(halted), .result(result));
+
+   always #5 clk = !clk;
+
+   task asm(input integer addr, input [3:0] op, input [3:0] rd,
+	    input [7:0] arg);
+      u_cpu.imem[addr] = {op, rd, arg};
+   endtask
+
+   integer outer;
+   integer idx;
+   initial begin
+      if (!$value$plusargs("outer=%d", outer))
+	outer = 200;
+
+      for (idx = 0 ; idx < 1024 ; idx = idx + 1)
+	u_cpu.dmem[idx] = idx * 32'h9e3779b9;
+      for (idx = 0 ; idx < 256 ; idx = idx + 1)
+	u_cpu.imem[idx] = 16'hf000;
+
+      asm( 0, 4'h0, 9, 8'd3);		// li   r9, 3
+      asm( 1, 4'h0, 1, outer);		// li   r1, outer
+      asm( 2, 4'h0, 2, 8'd0);		// li   r2, 0
+      asm( 3, 4'h0, 3, 8'd250);		// li   r3, 250
+      asm( 4, 4'h8, 4, 8'h20);		// ld   r4, [r2]
+      asm( 5, 4'hc, 5, 8'h44);		// mul  r5, r4, r4
+      asm( 6, 4'h1, 6, 8'h65);		// add  r6, r6, r5
+      asm( 7, 4'h6, 7, 8'h69);		// shl  r7, r6, r9
+      asm( 8, 4'h5, 4, 8'h47);		// xor  r4, r4, r7
+      asm( 9, 4'h9, 0, 8'h24);		// st   [r2], r4
+      asm(10, 4'hb, 2, 8'd1);		// addi r2, 1
+      asm(11, 4'hb, 3, 8'hff);		// addi r3, -1
+      asm(12, 4'ha, 3, 8'd4);		// bnz  r3, 4
+      asm(13, 4'hb, 1, 8'hff);		// addi r1, -1
+      asm(14, 4'ha, 1, 8'd2);		// bnz  r1, 2
+      asm(15, 4'hf, 0, 8'd0);		// halt
+
+      #12 rst = 1'b0;
+      wait (halted);
+      $display("cpu: result=%h time=%0t", result, $time);
+      $finish;
+   end
+
+endmodule
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: waveform dumping.
+ *
+ * An array of counters with different step sizes is clocked for a
+ * number of cycles with every signal in the design dumped to a VCD
+ * file. This measures the cost of the value change callbacks and of
+ * writing the dump file.
+ */
+
+`timescale 1ns/1ps
+
+module counter #(parameter STEP = 1)
+   (input wire clk, output reg [15:0] count, output wire carry);
+
+   initial count = 16'd0;
+
+   always @(posedge clk)
+     count <= count + STEP;
+
+   assign carry = &count[3:0];
+
+endmodule
+
+module bench_dump;
+
+   localparam COUNTERS = 256;
+
+   reg clk = 1'b0;
+   wire [COUNTERS-1:0] carry;
+
+   always #5 clk = !clk;
+
+   genvar gi;
+   generate
+      for (gi = 0 ; gi < COUNTERS ; gi = gi + 1) begin : cnt
+	 wire [15:0] count;
+	 counter #(.STEP(gi + 1)) u_cnt(.clk(clk), .count(count),
+					 .carry(carry[gi]));
+      end
+   endgenerate
+
+   integer cycles;
+   initial begin
+      if (!$value$plusargs("cycles=%d", cycles))
+	cycles = 20000;
+
+      $dumpfile("bench_dump.vcd");
+      $dumpvars(0, bench_dump);
+
+      repeat (cycles) @(posedge clk);
+      $display("dump: carry=%h", carry);
+      $finish;
+   end
+
+endmodule
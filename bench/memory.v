@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: memory-heavy test bench.
+ *
+ * A clocked dual port RAM model is driven by a test bench that writes
+ * and reads pseudo-random addresses every cycle, while a second
+ * thread runs a long behavioral loop of read-modify-write accesses
+ * to a large array. This exercises array word access, both from
+ * procedural code and through clocked events.
+ */
+
+`timescale 1ns/1ps
+
+module ram2p #(parameter AW = 14, parameter DW = 32)
+   (input wire clk,
+    input wire we, input wire [AW-1:0] waddr, input wire [DW-1:0] wdata,
+    input wire [AW-1:0] raddr, output reg [DW-1:0] rdata);
+
+   reg [DW-1:0] mem [0:(1<<AW)-1];
+
+   always @(posedge clk) begin
+      if (we)
+	mem[waddr] <= wdata;
+      rdata <= mem[raddr];
+   end
+
+endmodule
+
+module bench_memory;
+
+   localparam AW = 14;
+
+   reg clk = 1'b0;
+   reg we = 1'b0;
+   reg [AW-1:0] waddr, raddr;
+   reg [31:0] wdata;
+   wire [31:0] rdata;
+
+   ram2p #(.AW(AW)) u_ram(.clk(clk), .we(we), .waddr(waddr), .wdata(wdata),
+			  .raddr(raddr), .rdata(rdata));
+
+   always #5 clk = !clk;
+
+     // Drive the RAM ports with pseudo-random addresses and data.
+   reg [31:0] lfsr = 32'h1;
+   reg [31:0] port_sum = 32'h0;
+   integer cycles, cyc;
+   reg port_done = 1'b0;
+   initial begin
+      if (!$value$plusargs("cycles=%d", cycles))
+	cycles = 100000;
+
+      waddr = 0;
+      raddr = 0;
+      wdata = 0;
+      for (cyc = 0 ; cyc < cycles ; cyc = cyc + 1) begin
+	 @(negedge clk);
+	 lfsr = {lfsr[30:0], lfsr[31] ^ lfsr[21] ^ lfsr[1] ^ lfsr[0]};
+	 we = lfsr[0];
+	 waddr = lfsr[AW:1];
+	 raddr = lfsr[AW+15:16];
+	 wdata = lfsr ^ port_sum;
+	 port_sum = port_sum + rdata;
+      end
+      port_done = 1'b1;
+   end
+
+     // Behavioral read-modify-write loop over a large array.
+   localparam WORDS = 65536;
+   reg [31:0] mem [0:WORDS-1];
+   reg [31:0] addr, sum;
+   integer passes, pass, idx;
+   reg loop_done = 1'b0;
+   initial begin
+      if (!$value$plusargs("passes=%d", passes))
+	passes = 20;
+
+      for (idx = 0 ; idx < WORDS ; idx = idx + 1)
+	mem[idx] = idx * 32'h9e3779b9;
+
+      addr = 32'd1;
+      sum = 32'd0;
+      for (pass = 0 ; pass < passes ; pass = pass + 1) begin
+	 for (idx = 0 ; idx < WORDS ; idx = idx + 1) begin
+	    addr = addr * 32'd1664525 + 32'd1013904223;
+	    sum = sum + mem[addr[31:16]];
+	    mem[addr[31:16]] = sum ^ mem[idx];
+	 end
+	   // Let the clocked side run between passes.
+	 #10;
+      end
+      loop_done = 1'b1;
+   end
+
+   initial begin
+      wait (port_done && loop_done);
+      $display("memory: port_sum=%h sum=%h", port_sum, sum);
+      $finish;
+   end
+
+endmodule
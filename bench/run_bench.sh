@@ -0,0 +1,222 @@
+#!/bin/sh
+#
+# Copyright (c) 2026 agent (agent@local)
+#
+#    This source code is free software; you can redistribute it
+#    and/or modify it in source code form under the terms of the GNU
+#    General Public License as published by the Free Software
+#    Foundation; either version 2 of the License, or (at your option)
+#    any later version.
+#
+# This script runs the vvp throughput benchmarks. It is normally run
+# by "make bench" in the build directory, but it can be run by hand
+# against any installed Icarus Verilog:
+#
+#    sh run_bench.sh [-s srcdir] [-i iverilog-command] [-v vvp-command]
+#                    [-w workdir] [-o results.csv] [-g gate-stages]
+#                    [workload...]
+#
+# The workloads are cpu, gates, memory, classes and dump (all of them
+# by default). Each workload is compiled with iverilog and run with
+# "vvp -v", and the statistics that vvp prints are used to measure:
+#
+#    compile_s     wall clock time of the iverilog compile
+#    load_s        CPU time vvp took to load the design
+#    run_s         CPU time of the simulation
+#    events        scheduler events (time steps, thread, assign and
+#                  other events) executed
+#    events_per_s  events / run_s
+#    peak_rss_kb   peak resident set size of vvp, in KBytes (this
+#                  assumes the Linux ru_maxrss units)
+#
+# The results are written as CSV (one line per workload, after a
+# header line) to the results file, and as a table to stdout.
+#
+
+srcdir=`dirname "$0"`
+iverilog=iverilog
+vvp=vvp
+workdir=bench-work
+results=bench-results.csv
+gate_stages=2000
+
+while getopts "s:i:v:w:o:g:" opt ; do
+    case $opt in
+    s) srcdir="$OPTARG" ;;
+    i) iverilog="$OPTARG" ;;
+    v) vvp="$OPTARG" ;;
+    w) workdir="$OPTARG" ;;
+    o) results="$OPTARG" ;;
+    g) gate_stages="$OPTARG" ;;
+    *) echo "Usage: $0 [-s srcdir] [-i iverilog] [-v vvp] [-w workdir]" \
+            "[-o results] [-g gate-stages] [workload...]" >&2
+       exit 1 ;;
+    esac
+done
+shift `expr $OPTIND - 1`
+
+workloads="$*"
+if test -z "$workloads" ; then
+    workloads="cpu gates memory classes dump"
+fi
+
+mkdir -p "$workdir" || exit 1
+srcdir=`cd "$srcdir" && pwd`
+
+# Print the current time in seconds, with a fraction if date can.
+now()
+{
+    t=`date +%s.%N 2>/dev/null`
+    case $t in
+    *N*|'') date +%s ;;
+    *) echo $t ;;
+    esac
+}
+
+# Generate the flat gate-level netlist of the gates workload and its
+# SDF file. Stage i is a flip-flop fed by a multiplexer and an
+# exclusive-or whose inputs are picked from other stages, so that the
+# activity spreads through the whole netlist. Stage 0 is fed through
+# an inverter from the last stage, which starts the activity.
+gen_gates()
+{
+    awk -v n="$1" -v vfile="$2" -v sfile="$3" 'BEGIN {
+        print "`timescale 1ns/10ps" > vfile
+        print "module gates_netlist (clk, out);" > vfile
+        print "   input clk;" > vfile
+        print "   output out;" > vfile
+        for (i = 0 ; i < n ; i += 1)
+            printf "   wire q%d, m%d, d%d;\n", i, i, i > vfile
+        print "   wire nq;" > vfile
+        printf "   INV n0 (.Y(nq), .A(q%d));\n", n-1 > vfile
+        for (i = 0 ; i < n ; i += 1) {
+            a = (i == 0) ? "nq" : sprintf("q%d", i-1)
+            printf "   MUX2 m%d_u (.Y(m%d), .A(%s), .B(q%d), .S(q%d));\n",
+                   i, i, a, (i*7+3)%n, (i*13+5)%n > vfile
+            printf "   XOR2 x%d_u (.Y(d%d), .A(m%d), .B(q%d));\n",
+                   i, i, i, (i*11+1)%n > vfile
+            printf "   DFF f%d_u (.Q(q%d), .D(d%d), .CK(clk));\n",
+                   i, i, i > vfile
+        }
+        printf "   assign out = q%d;\n", n-1 > vfile
+        print "endmodule" > vfile
+
+        print "(DELAYFILE" > sfile
+        print " (SDFVERSION \"3.0\")" > sfile
+        print " (DESIGN \"gates_netlist\")" > sfile
+        print " (TIMESCALE 1ns)" > sfile
+        print " (CELL (CELLTYPE \"INV\") (INSTANCE n0)" > sfile
+        print "  (DELAY (ABSOLUTE (IOPATH A Y (0.2:0.3:0.4) (0.2:0.3:0.4)))))" > sfile
+        for (i = 0 ; i < n ; i += 1) {
+            r = (i % 5) / 10.0
+            printf " (CELL (CELLTYPE \"MUX2\") (INSTANCE m%d_u)\n", i > sfile
+            printf "  (DELAY (ABSOLUTE\n" > sfile
+            printf "   (IOPATH A Y (%.2f) (%.2f))\n", 0.4+r, 0.5+r > sfile
+            printf "   (IOPATH B Y (%.2f) (%.2f))\n", 0.4+r, 0.5+r > sfile
+            printf "   (IOPATH S Y (%.2f) (%.2f)))))\n", 0.6+r, 0.7+r > sfile
+            printf " (CELL (CELLTYPE \"XOR2\") (INSTANCE x%d_u)\n", i > sfile
+            printf "  (DELAY (ABSOLUTE\n" > sfile
+            printf "   (IOPATH A Y (%.2f) (%.2f))\n", 0.5+r, 0.5+r > sfile
+            printf "   (IOPATH B Y (%.2f) (%.2f)))))\n", 0.5+r, 0.5+r > sfile
+            printf " (CELL (CELLTYPE \"DFF\") (INSTANCE f%d_u)\n", i > sfile
+            printf "  (DELAY (ABSOLUTE\n" > sfile
+            printf "   (IOPATH (posedge CK) Q (%.2f) (%.2f)))))\n", 0.8+r, 0.9+r > sfile
+        }
+        print ")" > sfile
+    }'
+
+    cat > "$4" <<EOF
+\`timescale 1ns/10ps
+module bench_gates;
+   reg clk = 1'b0;
+   wire out;
+   integer cycles;
+
+   gates_netlist dut (.clk(clk), .out(out));
+
+   always #5 clk = !clk;
+
+   initial begin
+      \$sdf_annotate("gates.sdf", dut);
+      if (!\$value\$plusargs("cycles=%d", cycles))
+	cycles = 5000;
+      repeat (cycles) @(posedge clk);
+      \$display("gates: out=%b", out);
+      \$finish;
+   end
+endmodule
+EOF
+}
+
+# Pull a measurement out of a "vvp -v" log.
+parse_log()
+{
+    awk '
+    / \.\.\. .* seconds, / {
+        secs[nsecs++] = $2
+        split($4, sz, "/")
+        rss = sz[1] * 1024
+    }
+    / time steps / || / thread schedule events/ || / assign events/ ||
+    / other events / {
+        events += $1
+    }
+    END {
+        load = (nsecs > 0) ? secs[0] : 0
+        run = (nsecs > 1) ? secs[1] : 0
+        rate = (run > 0) ? events / run : 0
+        printf "%s,%s,%d,%.0f,%.0f\n", load, run, events, rate, rss
+    }' "$1"
+}
+
+echo "workload,compile_s,load_s,run_s,events,events_per_s,peak_rss_kb,status" \
+    > "$results"
+printf "%-10s %10s %10s %10s %12s %12s %12s %s\n" workload compile_s \
+    load_s run_s events events/s peak_rss_kb status
+
+for w in $workloads ; do
+    flags=
+    case $w in
+    cpu)     srcs="$srcdir/cpu.v" ;;
+    memory)  srcs="$srcdir/memory.v" ;;
+    classes) srcs="$srcdir/classes.sv" ; flags="-g2012" ;;
+    dump)    srcs="$srcdir/dump.v" ;;
+    gates)
+        gen_gates "$gate_stages" "$workdir/gates_netlist.v" \
+                  "$workdir/gates.sdf" "$workdir/gates_tb.v"
+        srcs="$srcdir/cells.v $workdir/gates_netlist.v $workdir/gates_tb.v"
+        flags="-gspecify -Ttyp"
+        ;;
+    *)  echo "$0: unknown workload $w" >&2
+        continue ;;
+    esac
+
+    status=ok
+    start=`now`
+    if ! $iverilog $flags -o "$workdir/$w.vvp" $srcs \
+            > "$workdir/$w.compile.log" 2>&1 ; then
+        status=compile-failed
+    fi
+    stop=`now`
+    compile_s=`echo "$start $stop" | awk '{ printf "%.3f", $2 - $1 }'`
+
+    if test $status = ok ; then
+        # vvp is run in the work directory, so that the SDF and VCD
+        # files are found and written there.
+        if ! ( cd "$workdir" && $vvp -v "$w.vvp" > "$w.log" 2>&1 ) ; then
+            status=run-failed
+        elif ! grep "^$w: " "$workdir/$w.log" > /dev/null ; then
+            status=no-result
+        fi
+        stats=`parse_log "$workdir/$w.log"`
+    else
+        stats="0,0,0,0,0"
+    fi
+
+    echo "$w,$compile_s,$stats,$status" >> "$results"
+    echo "$w,$compile_s,$stats,$status" | awk -F, '{
+        printf "%-10s %10s %10s %10s %12s %12s %12s %s\n",
+               $1, $2, $3, $4, $5, $6, $7, $8 }'
+done
+
+rm -f "$workdir/bench_dump.vcd"
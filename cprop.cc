@@ -116,9 +116,10 @@ void cprop_functor::lpm_concat(Design*des, NetConcat*obj)
       connect(obj->pin(0), result_obj->pin(0));
 
 	// Note that this will leave the const inputs to dangle. They
-	// will be reaped by other passes of cprop_functor.
+	// will be reaped by the cprop_dc_functor.
       delete obj;
 
+      des->add_work_readers(result_obj->pin(0).nexus());
       count += 1;
 }
 
@@ -190,6 +191,7 @@ void cprop_functor::lpm_mux(Design*des, NetMux*obj)
 	    connect(tmp->pin(1), obj->pin_Data(0));
       delete obj;
       des->add_node(tmp);
+      des->add_work_readers(tmp->pin(0).nexus());
       count += 1;
 }
 
@@ -326,6 +328,7 @@ void cprop_functor::lpm_part_select(Design*des, NetPartSelect*obj)
 	    delete obj_set[idx];
       }
 
+      des->add_work_readers(concat->pin(0).nexus());
       count += 1;
 }
 
@@ -428,17 +431,18 @@ void cprop_dc_functor::lpm_const(Design*, NetConst*obj)
 
 void cprop(Design*des)
 {
-	// Continually propagate constants until a scan finds nothing
-	// to do.
+	// Propagate constants until the work list drains. Every
+	// node is visited once, and after that only the nodes that
+	// read a nexus whose drivers were changed by an optimization
+	// are visited again. This reaches the same result as scanning
+	// the entire design until a scan finds nothing to do.
       cprop_functor prop;
-      do {
-	    prop.count = 0;
-	    des->functor(&prop);
-	    if (verbose_flag) {
-		  cout << " ... Iteration detected "
-		       << prop.count << " optimizations." << endl << flush;
-	    }
-      } while (prop.count > 0);
+      prop.count = 0;
+      des->functor_work(&prop);
+      if (verbose_flag) {
+	    cout << " ... Work list detected "
+		 << prop.count << " optimizations." << endl << flush;
+      }
 
       if (verbose_flag) {
 	    cout << " ... Look for dangling constants" << endl << flush;
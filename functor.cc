@@ -183,6 +183,73 @@ void Design::functor(functor_t*fun)
       }
 }
 
+/*
+ * The work list holds each node at most once. The work_map_ locates
+ * the list entry for a node so that Design::del_node can remove a
+ * node from the list in constant time.
+ */
+void Design::add_work_node(NetNode*net)
+{
+      assert(work_active_);
+      if (work_map_.find(net) != work_map_.end())
+	    return;
+
+      work_list_.push_back(net);
+      work_map_[net] = -- work_list_.end();
+}
+
+/*
+ * Queue all the nodes that take input from the nexus. A
+ * NetSubstitute passes constant values through (see
+ * Nexus::drivers_constant) so also queue the readers of its output.
+ */
+void Design::add_work_readers(Nexus*nex)
+{
+      for (Link*cur = nex->first_nlink() ; cur ; cur = cur->next_nlink()) {
+	    if (cur->get_dir() != Link::INPUT)
+		  continue;
+
+	    NetNode*node = dynamic_cast<NetNode*> (cur->get_obj());
+	    if (node == 0)
+		  continue;
+
+	    bool queued = work_map_.find(node) != work_map_.end();
+	    add_work_node(node);
+
+	    if (queued)
+		  continue;
+
+	    if (NetSubstitute*sub = dynamic_cast<NetSubstitute*> (node))
+		  add_work_readers(sub->pin(0).nexus());
+      }
+}
+
+void Design::functor_work(functor_t*fun)
+{
+      assert(! work_active_);
+      work_active_ = true;
+
+	/* Seed the work list with all the nodes, in the same order
+	   that the Design::functor method would scan them. */
+      if (nodes_) {
+	    NetNode*cur = nodes_;
+	    do {
+		  add_work_node(cur);
+		  cur = cur->node_next_;
+	    } while (cur != nodes_);
+      }
+
+      while (! work_list_.empty()) {
+	    NetNode*cur = work_list_.front();
+	    work_list_.pop_front();
+	    work_map_.erase(cur);
+
+	    cur->functor_node(this, fun);
+      }
+
+      work_active_ = false;
+}
+
 
 void NetNode::functor_node(Design*, functor_t*)
 {
@@ -0,0 +1,82 @@
+// Check the order of the bits when a dynamic array of packed words is
+// cast to a vector. Element 0 is the most significant word. The words
+// use the 8, 16 and 32 bit lanes and a width that takes more than one
+// word, for both two and four state elements.
+module top;
+   typedef logic [31:0]  l32_t;
+   typedef bit   [31:0]  b32_t;
+   typedef bit   [17:0]  b18_t;
+   typedef logic [35:0]  l36_t;
+   typedef bit   [39:0]  b40_t;
+   typedef logic [139:0] l140_t;
+   typedef logic [47:0]  l48_t;
+
+   logic [7:0]  d8[];
+   bit   [5:0]  d6[];
+   logic [11:0] d12[];
+   bit   [19:0] d20[];
+   logic [69:0] d70[];
+   integer errors;
+
+   initial begin
+      errors = 0;
+
+      d8 = new[4];
+      d8[0] = 8'h12;
+      d8[1] = 8'h34;
+      d8[2] = 8'b1x0z_0110;
+      d8[3] = 8'h78;
+      if (l32_t'(d8) !== 32'b00010010_00110100_1x0z0110_01111000) begin
+	 $display("FAILED: logic [7:0] gives %b", l32_t'(d8));
+	 errors = errors + 1;
+      end
+      if (b32_t'(d8) !== 32'h1234_8678) begin
+	 $display("FAILED: logic [7:0] as bits gives %h", b32_t'(d8));
+	 errors = errors + 1;
+      end
+
+      d6 = new[3];
+      d6[0] = 6'h2a;
+      d6[1] = 6'h15;
+      d6[2] = 6'h3f;
+      if (b18_t'(d6) !== 18'b101010_010101_111111) begin
+	 $display("FAILED: bit [5:0] gives %b", b18_t'(d6));
+	 errors = errors + 1;
+      end
+
+      d12 = new[3];
+      d12[0] = 12'habc;
+      d12[1] = 12'hx5z;
+      d12[2] = 12'h123;
+      if (l36_t'(d12) !== {12'habc, 12'hx5z, 12'h123}) begin
+	 $display("FAILED: logic [11:0] gives %h", l36_t'(d12));
+	 errors = errors + 1;
+      end
+
+      d20 = new[2];
+      d20[0] = 20'h12345;
+      d20[1] = 20'habcde;
+      if (b40_t'(d20) !== 40'h12345_abcde) begin
+	 $display("FAILED: bit [19:0] gives %h", b40_t'(d20));
+	 errors = errors + 1;
+      end
+
+      d70 = new[2];
+      d70[0] = 70'h3f_0123_4567_89ab_cdef;
+      d70[1] = {6'bx0z1x0, 64'hfedc_ba98_7654_3210};
+      if (l140_t'(d70) !== {70'h3f_0123_4567_89ab_cdef,
+			    6'bx0z1x0, 64'hfedc_ba98_7654_3210}) begin
+	 $display("FAILED: logic [69:0] gives %h", l140_t'(d70));
+	 errors = errors + 1;
+      end
+
+	// The new words of a resized array are X.
+      d8 = new[6](d8);
+      if (l48_t'(d8) !== {32'b00010010_00110100_1x0z0110_01111000, 16'hxxxx}) begin
+	 $display("FAILED: resized logic [7:0] gives %b", l48_t'(d8));
+	 errors = errors + 1;
+      end
+
+      if (errors == 0) $display("PASSED");
+   end
+endmodule
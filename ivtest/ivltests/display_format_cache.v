@@ -0,0 +1,29 @@
+// Check that a $display call that runs many times uses the right
+// format each time. The format of a call is parsed once and kept when
+// it is a literal or a parameter, but a format in a string variable
+// or a string expression may change from one call to the next.
+module top;
+   parameter FMT = "param %0d";
+   string fmt, tag;
+   integer i;
+
+   initial begin
+      fmt = "a=%0d";
+      tag = "x";
+      for (i = 0 ; i < 3 ; i = i + 1) begin
+	 $display("lit %0d %h %5d|", i, i[7:0], i);
+	 $display(FMT, i);
+	 $display(fmt, i);
+	 $display({tag, "=%0d"}, i);
+	 $write("w%0d ", i);
+	 $display("|");
+	 if (i == 0) begin
+	    fmt = "b=%0d";
+	    tag = "y";
+	 end else begin
+	    fmt = "c[%0d]";
+	    tag = "zz";
+	 end
+      end
+   end
+endmodule
@@ -0,0 +1,60 @@
+// Check the counter based $ivl_urandom streams. Stream 0 with seed 0
+// is the known answer of Philox4x32-10 for a zero key and counter.
+// The values of a stream do not depend on what the other streams take,
+// and $ivl_random_seed restarts every stream from the new seed.
+module sub;
+   task draw(output [31:0] v);
+      v = $ivl_urandom;
+   endtask
+endmodule
+
+module top;
+   sub u1();
+   sub u2();
+
+   reg [31:0] v;
+   integer r, errors;
+
+   task check(input [31:0] got, input [31:0] want, input [8*16:1] what);
+      if (got !== want) begin
+	 $display("FAILED: %0s gives %h, expected %h", what, got, want);
+	 errors = errors + 1;
+      end
+   endtask
+
+   initial begin
+      errors = 0;
+
+      v = $ivl_urandom(0); check(v, 32'h6627e8d5, "stream 0");
+      v = $ivl_urandom(0); check(v, 32'he169c58d, "stream 0");
+      v = $ivl_urandom(0); check(v, 32'hbc57ac4c, "stream 0");
+      v = $ivl_urandom(0); check(v, 32'h9b00dbd8, "stream 0");
+
+	// Interleaving the numbered streams does not change them.
+      v = $ivl_urandom(1); check(v, 32'h844515e1, "stream 1");
+      v = $ivl_urandom(2); check(v, 32'h0661d677, "stream 2");
+      v = $ivl_urandom(2); check(v, 32'hb6826759, "stream 2");
+      v = $ivl_urandom(1); check(v, 32'hf08d6eaa, "stream 1");
+      v = $ivl_urandom(1); check(v, 32'h0f19c053, "stream 1");
+      v = $ivl_urandom(2); check(v, 32'h262148c6, "stream 2");
+
+	// The stream number has 64 bits.
+      v = $ivl_urandom(64'h1_0000_0000); check(v, 32'h2dce73e5, "stream 2**32");
+
+	// Without a stream each scope has its own.
+      v = $ivl_urandom; check(v, 32'h69d15739, "top");
+      u1.draw(v); check(v, 32'ha0db0473, "u1");
+      u2.draw(v); check(v, 32'h274724e3, "u2");
+      u1.draw(v); check(v, 32'h01f16d23, "u1");
+      v = $ivl_urandom; check(v, 32'hc4e4e1a5, "top");
+
+	// A new seed restarts all the streams.
+      $ivl_random_seed(5);
+      v = $ivl_urandom(0); check(v, 32'hc417681d, "seed 5 stream 0");
+      v = $ivl_urandom(1); check(v, 32'h63319a34, "seed 5 stream 1");
+      r = $ivl_urandom_range(10, 1, 3); check(r, 2, "seed 5 range");
+      v = $ivl_urandom; check(v, 32'h48b54466, "seed 5 top");
+
+      if (errors == 0) $display("PASSED");
+   end
+endmodule
@@ -0,0 +1,73 @@
+// Check that queue elements keep their values and order when the
+// storage of the queue wraps around. The elements cover the 8, 16 and
+// 32 bit lanes and a width that takes more than one word, with X and
+// Z bits in the four state elements.
+module top;
+   byte         q8[$];
+   logic [11:0] q12[$];
+   bit   [19:0] q20[$];
+   logic [69:0] q70[$];
+   integer idx, errors;
+
+   function byte v8(input integer n);
+      v8 = n * 7;
+   endfunction
+
+   function logic [11:0] v12(input integer n);
+      v12 = {n[9:0], 2'bxz};
+   endfunction
+
+   function bit [19:0] v20(input integer n);
+      v20 = n ^ 20'h5a5a5;
+   endfunction
+
+   function logic [69:0] v70(input integer n);
+      v70 = {n, 6'bz0x1z0, ~n};
+   endfunction
+
+`define RUN_TEST(Q, VAL, NAME) \
+      for (idx = 0 ; idx < 200 ; idx = idx + 1) begin \
+	 Q.push_back(VAL(idx)); \
+	 if (Q.size() > 5) begin \
+	    if (Q.pop_front() !== VAL(idx-5)) begin \
+	       $display("FAILED: %s pop_front at %0d", NAME, idx); \
+	       errors = errors + 1; \
+	    end \
+	 end \
+      end \
+      for (idx = 0 ; idx < 200 ; idx = idx + 1) begin \
+	 Q.push_front(VAL(1000+idx)); \
+	 if (Q.pop_back() !== VAL(idx < 5 ? 199-idx : 995+idx)) begin \
+	    $display("FAILED: %s pop_back at %0d", NAME, idx); \
+	    errors = errors + 1; \
+	 end \
+      end \
+      Q[2] = VAL(7); \
+      for (idx = 0 ; idx < 100 ; idx = idx + 1) \
+	 Q.push_back(VAL(2000+idx)); \
+      if (Q.size() !== 105) begin \
+	 $display("FAILED: %s size is %0d", NAME, Q.size()); \
+	 errors = errors + 1; \
+      end \
+      for (idx = 0 ; idx < 105 ; idx = idx + 1) begin \
+	 if (Q[idx] !== VAL(idx == 2 ? 7 : idx < 5 ? 1199-idx : 1995+idx)) begin \
+	    $display("FAILED: %s[%0d] is wrong", NAME, idx); \
+	    errors = errors + 1; \
+	 end \
+      end \
+      Q.delete(); \
+      Q.push_front(VAL(3)); \
+      if (Q.size() !== 1 || Q[0] !== VAL(3)) begin \
+	 $display("FAILED: %s after delete", NAME); \
+	 errors = errors + 1; \
+      end
+
+   initial begin
+      errors = 0;
+      `RUN_TEST(q8, v8, "q8")
+      `RUN_TEST(q12, v12, "q12")
+      `RUN_TEST(q20, v20, "q20")
+      `RUN_TEST(q70, v70, "q70")
+      if (errors == 0) $display("PASSED");
+   end
+endmodule
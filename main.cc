@@ -1275,9 +1275,19 @@ int main(int argc, char*argv[])
       while (!net_func_queue.empty()) {
 	    net_func func = net_func_queue.front();
 	    net_func_queue.pop();
-	    if (verbose_flag)
+	    struct tms func_cycles[2];
+	    if (verbose_flag) {
 		  cerr<<" -F "<<net_func_to_name(func)<< " ..." <<endl;
+		  if (times_flag)
+			times(func_cycles+0);
+	    }
 	    func(des);
+	    if (verbose_flag && times_flag) {
+		  times(func_cycles+1);
+		  cerr<<" -F "<<net_func_to_name(func)<<" done, "
+		      <<cycles_diff(func_cycles+1, func_cycles+0)
+		      <<" seconds."<<endl;
+	    }
       }
 
       if (verbose_flag) {
@@ -45,6 +45,7 @@ Design:: Design()
       des_precision_ = 0;
       nodes_functor_cur_ = 0;
       nodes_functor_nxt_ = 0;
+      work_active_ = false;
       des_delay_sel_ = Design::TYP;
 }
 
@@ -936,6 +937,9 @@ void Design::add_node(NetNode*net)
       }
       nodes_ = net;
       net->design_ = this;
+
+      if (work_active_)
+	    add_work_node(net);
 }
 
 void Design::del_node(NetNode*net)
@@ -953,6 +957,15 @@ void Design::del_node(NetNode*net)
       if (net == nodes_functor_cur_)
 	    nodes_functor_cur_ = 0;
 
+	/* Make sure the work list does not hold on to a stale node. */
+      if (work_active_) {
+	    map<NetNode*,list<NetNode*>::iterator>::iterator cur = work_map_.find(net);
+	    if (cur != work_map_.end()) {
+		  work_list_.erase(cur->second);
+		  work_map_.erase(cur);
+	    }
+      }
+
 	/* Now perform the actual delete. */
       if (nodes_ == net)
 	    nodes_ = net->node_prev_;
@@ -21,6 +21,7 @@
 # include  "netmisc.h"
 # include  "compiler.h"
 # include  <typeinfo>
+# include  <cstdio>
 # include  "ivl_assert.h"
 
 #if __cplusplus < 201103L
@@ -57,41 +58,114 @@ static NetExpr* fix_assign_value(const NetNet*lhs, NetExpr*rhs)
       return rhs;
 }
 
+/*
+ * Make a key that identifies the values of the (already width fixed)
+ * arguments of a constant function call. Return false if any of the
+ * arguments is not a constant, in which case the call is not cached.
+ */
+static bool make_eval_cache_key(const vector<NetExpr*>&args, string&key)
+{
+      key.clear();
+      for (size_t idx = 0 ; idx < args.size() ; idx += 1) {
+	    if (const NetEConst*ce = dynamic_cast<const NetEConst*>(args[idx])) {
+		  const verinum&val = ce->value();
+		  key += val.has_sign()? 's' : 'u';
+		  for (unsigned bit = 0 ; bit < val.len() ; bit += 1)
+			key += "01xz"[val[bit]];
+
+	    } else if (const NetECReal*re = dynamic_cast<const NetECReal*>(args[idx])) {
+		  char buf[64];
+		  snprintf(buf, sizeof buf, "r%a", re->value().as_double());
+		  key += buf;
+
+	    } else {
+		  return false;
+	    }
+	    key += ';';
+      }
+      return true;
+}
+
+/*
+ * Lay out a context map for the function: the return value, the
+ * input ports and the local variables, all without values.
+ */
+void NetFuncDef::make_context_(const LineInfo&loc,
+			       map<perm_string,LocalVar>&context_map) const
+{
+      LocalVar&return_var = context_map[scope()->basename()];
+      return_var.nwords = 0;
+      return_var.value  = 0;
+
+      for (size_t idx = 0 ; idx < port_count() ; idx += 1) {
+	    LocalVar&input_var = context_map[port(idx)->name()];
+	    input_var.nwords = 0;
+	    input_var.value  = 0;
+      }
+
+	// Ask the scope to collect definitions for local values. This
+	// fills in the context_map with local variables held by the scope.
+      scope()->evaluate_function_find_locals(loc, context_map);
+}
+
 NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<NetExpr*>&args) const
 {
-	// Make the context map.
       map<perm_string,LocalVar>::iterator ptr;
-      map<perm_string,LocalVar>context_map;
 
       if (debug_eval_tree) {
 	    cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
 		 << "Evaluate function " << scope()->basename() << endl;
       }
 
-	// Put the return value into the map...
-      LocalVar&return_var = context_map[scope()->basename()];
-      return_var.nwords = 0;
-      return_var.value  = 0;
+	// Cast the arguments to the types of the input ports.
+      ivl_assert(loc, port_count() == args.size());
+      vector<NetExpr*>port_args (args.size());
+      for (size_t idx = 0 ; idx < port_count() ; idx += 1)
+	    port_args[idx] = fix_assign_value(port(idx), args[idx]);
+
+	// If this function was already evaluated with these argument
+	// values, then reuse the result.
+      string cache_key;
+      bool cache_flag = make_eval_cache_key(port_args, cache_key);
+      if (cache_flag) {
+	    map<string,NetExpr*>::const_iterator hit = eval_cache_.find(cache_key);
+	    if (hit != eval_cache_.end()) {
+		  if (debug_eval_tree) {
+			cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
+			     << "Reuse result " << *hit->second
+			     << " of an earlier call." << endl;
+		  }
+		  for (size_t idx = 0 ; idx < port_args.size() ; idx += 1)
+			delete port_args[idx];
+		  return hit->second->dup_expr();
+	    }
+      }
+
+	// Get a context map, laid out by an earlier call if possible.
+      map<perm_string,LocalVar>*context_ptr;
+      if (context_pool_.empty()) {
+	    context_ptr = new map<perm_string,LocalVar>;
+	    make_context_(loc, *context_ptr);
+      } else {
+	    context_ptr = context_pool_.back();
+	    context_pool_.pop_back();
+      }
+      map<perm_string,LocalVar>&context_map = *context_ptr;
 
 	// Load the input ports into the map...
-      ivl_assert(loc, port_count() == args.size());
       for (size_t idx = 0 ; idx < port_count() ; idx += 1) {
 	    const NetNet*pnet = port(idx);
 	    perm_string aname = pnet->name();
-	    LocalVar&input_var = context_map[aname];
-	    input_var.nwords = 0;
-	    input_var.value  = fix_assign_value(pnet, args[idx]);
+	    ptr = context_map.find(aname);
+	    ivl_assert(loc, ptr != context_map.end());
+	    ptr->second.value = port_args[idx];
 
 	    if (debug_eval_tree) {
 		  cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
-		       << "   input " << aname << " = " << *args[idx] << endl;
+		       << "   input " << aname << " = " << *port_args[idx] << endl;
 	    }
       }
 
-	// Ask the scope to collect definitions for local values. This
-	// fills in the context_map with local variables held by the scope.
-      scope()->evaluate_function_find_locals(loc, context_map);
-
 	// Execute any variable initialization statements.
       if (const NetProc*init_proc = scope()->var_init())
 	    init_proc->evaluate_function(loc, context_map);
@@ -115,9 +189,10 @@ NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<Net
 	// Extract the result...
       ptr = context_map.find(scope()->basename());
       NetExpr*res = ptr->second.value;
-      context_map.erase(ptr);
+      ptr->second.value = 0;
 
-	// Cleanup the rest of the context.
+	// Clear the rest of the context, and keep the layout for the
+	// next call.
       for (ptr = context_map.begin() ; ptr != context_map.end() ; ++ptr) {
 
 	    unsigned nwords = ptr->second.nwords;
@@ -125,12 +200,14 @@ NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<Net
 		  NetExpr**array = ptr->second.array;
 		  for (unsigned idx = 0 ; idx < nwords ; idx += 1) {
 			delete array[idx];
+			array[idx] = 0;
 		  }
-		  delete [] ptr->second.array;
 	    } else {
 		  delete ptr->second.value;
+		  ptr->second.value = 0;
 	    }
       }
+      context_pool_.push_back(context_ptr);
 
       if (disable) {
 	    if (debug_eval_tree)
@@ -151,6 +228,8 @@ NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<Net
 		  else cerr << "<nil>";
 		  cerr << endl;
 	    }
+	    if (cache_flag && res)
+		  eval_cache_[cache_key] = res->dup_expr();
 	    return res;
       }
 
@@ -47,8 +47,13 @@ void Nexus::connect(Link&r)
 		  r.next_ = &r;
 		  r.nexus_ = this;
 		  driven_ = NO_GUESS;
+		  summary_clear_(summary_);
+		  summary_add_(summary_, &r);
+		  summary_valid_ = true;
 	    } else {
 		  driven_ = r_nexus->driven_;
+		  summary_ = r_nexus->summary_;
+		  summary_valid_ = r_nexus->summary_valid_;
 		  list_ = r_nexus->list_;
 		  list_->nexus_ = this;
 		  r_nexus->list_ = 0;
@@ -69,12 +74,27 @@ void Nexus::connect(Link&r)
 	    list_->next_ = &r;
 	    list_->nexus_ = 0;
 	    list_ = &r;
+
+	    if (summary_valid_)
+		  summary_add_(summary_, &r);
 	    return;
       }
 
       if (r_nexus->driven_ != Vz)
 	    driven_ = NO_GUESS;
 
+	// The links of the other nexus are spliced after the links of
+	// this nexus, so the first net of this nexus stays first.
+      if (summary_valid_ && r_nexus->summary_valid_) {
+	    summary_.inputs += r_nexus->summary_.inputs;
+	    summary_.outputs += r_nexus->summary_.outputs;
+	    summary_.passive_drivers += r_nexus->summary_.passive_drivers;
+	    if (summary_.first_net == 0)
+		  summary_.first_net = r_nexus->summary_.first_net;
+      } else {
+	    summary_valid_ = false;
+      }
+
 	// Splice the list of links from the "tmp" nexus to the end of
 	// this nexus. Adjust the nexus pointers as needed.
       Link*save_first = list_->next_;
@@ -154,7 +174,12 @@ const Nexus* Link::nexus() const
 
 void Link::set_dir(DIR d)
 {
+      if (dir_ == d)
+	    return;
+
       dir_ = d;
+      if (next_)
+	    find_nexus_()->summary_stale();
 }
 
 Link::DIR Link::get_dir() const
@@ -257,12 +282,17 @@ Nexus::Nexus(Link&that)
 	    that.next_ = &that;
 	    that.nexus_ = this;
 	    driven_ = NO_GUESS;
+	    summary_clear_(summary_);
+	    summary_add_(summary_, &that);
+	    summary_valid_ = true;
 
       } else {
 	    Nexus*tmp = that.find_nexus_();
 	    list_ = tmp->list_;
 	    list_->nexus_ = this;
 	    driven_ = tmp->driven_;
+	    summary_ = tmp->summary_;
+	    summary_valid_ = tmp->summary_valid_;
 	    name_ = tmp->name_;
 
 	    tmp->list_ = 0;
@@ -295,65 +325,76 @@ bool Nexus::assign_lval() const
       return false;
 }
 
-void Nexus::count_io(unsigned&inp, unsigned&out) const
-{
-      for (const Link*cur = first_nlink() ;  cur ; cur = cur->next_nlink()) {
-	    switch (cur->get_dir()) {
-		case Link::INPUT:
-		  inp += 1;
-		  break;
-		case Link::OUTPUT:
-		  out += 1;
+void Nexus::summary_clear_(summary_t&sum)
+{
+      sum.inputs = 0;
+      sum.outputs = 0;
+      sum.passive_drivers = 0;
+      sum.first_net = 0;
+}
+
+void Nexus::summary_add_(summary_t&sum, const Link*cur)
+{
+      const NetNet*net = dynamic_cast<const NetNet*>(cur->get_obj());
+      if (net && sum.first_net == 0)
+	    sum.first_net = net;
+
+      switch (cur->get_dir()) {
+	  case Link::INPUT:
+	    sum.inputs += 1;
+	    break;
+	  case Link::OUTPUT:
+	    sum.outputs += 1;
+	    break;
+	  case Link::PASSIVE:
+	      // If this is some kind of net, see if it is the sort
+	      // that might drive the nexus. Note that supply0/1 and
+	      // tri0/1 nets are classified as OUTPUT.
+	    if (net) switch (net->type()) {
+		case NetNet::WAND:
+		case NetNet::WOR:
+		case NetNet::TRIAND:
+		case NetNet::TRIOR:
+		case NetNet::REG:
+		  sum.passive_drivers += 1;
 		  break;
 		default:
 		  break;
 	    }
+	    break;
       }
 }
 
-bool Nexus::has_floating_input() const
+const Nexus::summary_t& Nexus::summary_get_() const
 {
-      bool found_input = false;
-      for (const Link*cur = first_nlink() ;  cur ; cur = cur->next_nlink()) {
-	    if (cur->get_dir() == Link::OUTPUT)
-		  return false;
+      if (summary_valid_)
+	    return summary_;
 
-	    if (cur->get_dir() == Link::INPUT)
-		  found_input = true;
-      }
+      summary_clear_(summary_);
+      for (const Link*cur = first_nlink() ;  cur ; cur = cur->next_nlink())
+	    summary_add_(summary_, cur);
 
-      return found_input;
+      summary_valid_ = true;
+      return summary_;
 }
 
-bool Nexus::drivers_present() const
+void Nexus::count_io(unsigned&inp, unsigned&out) const
 {
-      for (const Link*cur = first_nlink() ;  cur ; cur = cur->next_nlink()) {
-	    if (cur->get_dir() == Link::OUTPUT)
-		  return true;
-
-	    if (cur->get_dir() == Link::INPUT)
-		  continue;
+      const summary_t&sum = summary_get_();
+      inp += sum.inputs;
+      out += sum.outputs;
+}
 
-	      // Must be PASSIVE, so if it is some kind of net, see if
-	      // it is the sort that might drive the nexus. Note that
-	      // supply0/1 and tri0/1 nets are classified as OUTPUT.
-	    const NetPins*obj;
-	    unsigned pin;
-	    cur->cur_link(obj, pin);
-	    if (const NetNet*net = dynamic_cast<const NetNet*>(obj))
-		  switch (net->type()) {
-		      case NetNet::WAND:
-		      case NetNet::WOR:
-		      case NetNet::TRIAND:
-		      case NetNet::TRIOR:
-		      case NetNet::REG:
-			return true;
-		      default:
-			break;
-		  }
-      }
+bool Nexus::has_floating_input() const
+{
+      const summary_t&sum = summary_get_();
+      return sum.outputs == 0 && sum.inputs > 0;
+}
 
-      return false;
+bool Nexus::drivers_present() const
+{
+      const summary_t&sum = summary_get_();
+      return sum.outputs > 0 || sum.passive_drivers > 0;
 }
 
 void Nexus::drivers_delays(NetExpr*rise, NetExpr*fall, NetExpr*decay)
@@ -398,6 +439,8 @@ void Nexus::unlink(Link*that)
 	    assert(list_ == that);
 	    list_ = 0;
 	    driven_ = NO_GUESS;
+	    summary_clear_(summary_);
+	    summary_valid_ = true;
 	    that->nexus_ = 0;
 	    that->next_ = 0;
 	    return;
@@ -408,6 +451,25 @@ void Nexus::unlink(Link*that)
       if (that->get_dir() != Link::INPUT)
 	    driven_ = NO_GUESS;
 
+	// Take the link out of the summary. The link may belong to an
+	// object that is being destroyed, so do not look at its type;
+	// if the link might be a passive driver or the first net,
+	// leave the summary to be rebuilt instead.
+      if (summary_valid_) switch (that->get_dir()) {
+	  case Link::INPUT:
+	    summary_.inputs -= 1;
+	    break;
+	  case Link::OUTPUT:
+	    summary_.outputs -= 1;
+	    break;
+	  case Link::PASSIVE:
+	    if (summary_.passive_drivers > 0)
+		  summary_valid_ = false;
+	    break;
+      }
+      if (summary_valid_ && that->get_obj() == summary_.first_net)
+	    summary_valid_ = false;
+
 	// Look for the Link that points to "that". We know that there
 	// will be one because the list is a circle. When we find the
 	// prev pointer, then remove that from the list.
@@ -472,13 +534,7 @@ unsigned Nexus::vector_width() const
 
 NetNet* Nexus::pick_any_net()
 {
-      for (Link*cur = first_nlink() ; cur ; cur = cur->next_nlink()) {
-	    NetNet*sig = dynamic_cast<NetNet*>(cur->get_obj());
-	    if (sig != 0)
-		  return sig;
-      }
-
-      return 0;
+      return const_cast<NetNet*>(summary_get_().first_net);
 }
 
 NetNode* Nexus::pick_any_node()
@@ -679,6 +679,16 @@ void NetNet::type(NetNet::Type t)
       type_ = t;
 
       initialize_dir_();
+
+	// The type decides if a PASSIVE link of this net drives the
+	// nexus, so the link summaries need to be rebuilt.
+      if (! pins_are_virtual()) {
+	    for (unsigned idx = 0 ;  idx < pin_count() ;  idx += 1) {
+		  const Link&lnk = pin(idx);
+		  if (const Nexus*nex = lnk.nexus())
+			nex->summary_stale();
+	    }
+      }
 }
 
 
@@ -2151,6 +2161,20 @@ NetFuncDef::NetFuncDef(NetScope*s, NetNet*result, const vector<NetNet*>&po,
 
 NetFuncDef::~NetFuncDef()
 {
+      for (map<string,NetExpr*>::iterator cur = eval_cache_.begin()
+		 ; cur != eval_cache_.end() ; ++ cur )
+	    delete cur->second;
+
+	// The pooled contexts hold no values, only the local arrays.
+      for (size_t idx = 0 ; idx < context_pool_.size() ; idx += 1) {
+	    map<perm_string,LocalVar>*context_map = context_pool_[idx];
+	    for (map<perm_string,LocalVar>::iterator cur = context_map->begin()
+		       ; cur != context_map->end() ; ++ cur ) {
+		  if (cur->second.nwords > 0)
+			delete[] cur->second.array;
+	    }
+	    delete context_map;
+      }
 }
 
 const NetNet* NetFuncDef::return_sig() const
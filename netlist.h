@@ -419,6 +419,11 @@ class Nexus {
       ivl_nexus_t t_cookie() const { return t_cookie_; }
       void t_cookie(ivl_nexus_t) const;
 
+	/* Mark the link summary as stale. Links and nets call this
+	   when they change in a way that the nexus cannot follow
+	   incrementally, i.e. a link direction or net type change. */
+      void summary_stale() const { summary_valid_ = false; }
+
     private:
       Link*list_;
       void unlink(Link*);
@@ -429,6 +434,27 @@ class Nexus {
       enum VALUE { NO_GUESS, V0, V1, Vx, Vz, VAR };
       mutable VALUE driven_;
 
+	// The summary counts the links of the nexus so that the
+	// count_io, drivers_present and pick_any_net queries do not
+	// need to walk the link list. It is kept up to date as links
+	// are connected and unlinked. If an update cannot be made
+	// incrementally, the summary is marked stale and rebuilt by
+	// the next query.
+      struct summary_t {
+	    unsigned inputs;
+	    unsigned outputs;
+	      // PASSIVE links to nets that may drive the nexus.
+	    unsigned passive_drivers;
+	      // The first NetNet in the link list.
+	    const NetNet*first_net;
+      };
+      mutable summary_t summary_;
+      mutable bool summary_valid_;
+
+      const summary_t& summary_get_() const;
+      static void summary_clear_(summary_t&);
+      static void summary_add_(summary_t&, const Link*);
+
     private: // not implemented
       Nexus(const Nexus&);
       Nexus& operator= (const Nexus&);
@@ -3677,8 +3703,26 @@ class NetFuncDef : public NetBaseDef {
 
       void dump(ostream&, unsigned ind) const;
 
+    private:
+      void make_context_(const LineInfo&loc,
+			 std::map<perm_string,LocalVar>&context_map) const;
+
     private:
       NetNet*result_sig_;
+
+	// Constant functions have no side effects, so the result of
+	// a successful evaluation only depends on the argument
+	// values. Remember the results, keyed by the argument values,
+	// so that repeated calls with the same arguments are not
+	// evaluated again.
+      mutable std::map<std::string,NetExpr*> eval_cache_;
+
+	// Context maps for evaluate_function, already laid out with
+	// the return value, the ports and the local variables of the
+	// function. A call takes one and gives it back with the
+	// values cleared, so only the first call builds the layout.
+	// There is more than one if the function calls itself.
+      mutable std::vector<std::map<perm_string,LocalVar>*> context_pool_;
 };
 
 /*
@@ -5073,6 +5117,18 @@ class Design {
       void dump(ostream&) const;
       void functor(struct functor_t*);
       void join_islands(void);
+
+	/* The functor_work method applies the functor to nodes taken
+	   from a work list, instead of scanning the entire design. The
+	   list is initially filled with all the nodes of the design,
+	   and it is drained in FIFO order. While the work list is
+	   active, nodes added to the design are appended to the list,
+	   and nodes deleted from the design are removed from it. The
+	   functor uses add_work_readers to revisit the nodes that read
+	   a nexus that it changed. */
+      void functor_work(struct functor_t*);
+      void add_work_node(NetNode*);
+      void add_work_readers(Nexus*);
       int emit(struct target_t*) const;
 
 	// This is incremented by elaboration when an error is
@@ -5099,6 +5155,10 @@ class Design {
 	// These are in support of the node functor iterator.
       NetNode*nodes_functor_cur_;
       NetNode*nodes_functor_nxt_;
+	// These are in support of the node work list.
+      bool work_active_;
+      std::list<NetNode*> work_list_;
+      std::map<NetNode*,std::list<NetNode*>::iterator> work_map_;
 
 	// List the branches in the design.
       NetBranch*branches_;
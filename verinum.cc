@@ -26,6 +26,7 @@
 # include  <cmath> // Needed to get pow for as_double().
 # include  <cstdio> // Needed to get snprintf for as_string().
 # include  <algorithm>
+# include  <vector>
 
 #if !defined(HAVE_LROUND)
 /*
@@ -44,6 +45,93 @@ extern "C" long int lround(double x)
 
 static verinum::V add_with_carry(verinum::V l, verinum::V r, verinum::V&c);
 
+static inline uint64_t pad_word(bool flag)
+{
+      return flag? ~(uint64_t)0 : 0;
+}
+
+static inline uint64_t low_mask(unsigned cnt)
+{
+      return cnt >= 64? ~(uint64_t)0 : (((uint64_t)1 << cnt) - 1);
+}
+
+/*
+ * Return the index of the most significant set bit of a non-zero
+ * word.
+ */
+static unsigned top_bit(uint64_t word)
+{
+      assert(word != 0);
+      unsigned res = 0;
+      for (unsigned step = 32 ;  step > 0 ;  step /= 2) {
+	    if (word >> step) {
+		  word >>= step;
+		  res += step;
+	    }
+      }
+      return res;
+}
+
+/*
+ * Add two words and a carry in, returning the sum and leaving the
+ * carry out in carry.
+ */
+static inline uint64_t add_word(uint64_t l, uint64_t r, uint64_t&carry)
+{
+      uint64_t sum = l + r;
+      uint64_t c = sum < l;
+      sum += carry;
+      c |= sum < carry;
+      carry = c;
+      return sum;
+}
+
+/*
+ * Copy cnt bits from src (starting at soff) to dst (starting at
+ * doff). Bits past the end of src read as the pad value.
+ */
+static void copy_bits(verinum&dst, unsigned doff, const verinum&src,
+		      unsigned soff, unsigned cnt,
+		      verinum::V pad =verinum::V0)
+{
+      for (unsigned idx = 0 ;  idx < cnt ;  idx += 64) {
+	    uint64_t abits, bbits;
+	    src.get_bits(soff+idx, abits, bbits, pad);
+	    dst.set_bits(doff+idx, min(64U, cnt-idx), abits, bbits);
+      }
+}
+
+void verinum::alloc_(unsigned nbits)
+{
+      nbits_ = nbits;
+      unsigned nwords = nwords_(nbits);
+      bits_ = new uint64_t[2*nwords];
+      for (unsigned idx = 0 ;  idx < 2*nwords ;  idx += 1)
+	    bits_[idx] = 0;
+}
+
+void verinum::mask_top_()
+{
+      unsigned nwords = nwords_(nbits_);
+      if (nbits_ % 64) {
+	    uint64_t mask = low_mask(nbits_ % 64);
+	    bits_[nwords-1] &= mask;
+	    bits_[2*nwords-1] &= mask;
+      }
+}
+
+void verinum::fill_(V val)
+{
+      unsigned nwords = nwords_(nbits_);
+      uint64_t abits = pad_word(val & 1);
+      uint64_t bbits = pad_word(val & 2);
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1) {
+	    bits_[idx] = abits;
+	    bits_[nwords+idx] = bbits;
+      }
+      mask_top_();
+}
+
 verinum::verinum()
 : bits_(0), nbits_(0), has_len_(false), has_sign_(false), is_single_(false), string_flag_(false)
 {
@@ -52,10 +140,9 @@ verinum::verinum()
 verinum::verinum(const V*bits, unsigned nbits, bool has_len__)
 : has_len_(has_len__), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = nbits;
-      bits_ = new V [nbits];
+      alloc_(nbits);
       for (unsigned idx = 0 ;  idx < nbits ;  idx += 1) {
-	    bits_[idx] = bits[idx];
+	    set(idx, bits[idx]);
       }
 }
 
@@ -116,57 +203,38 @@ verinum::verinum(const string&s)
 : has_len_(true), has_sign_(false), is_single_(false), string_flag_(true)
 {
       string str = process_verilog_string_quotes(s);
-      nbits_ = str.length() * 8;
 
 	// Special case: The string "" is 8 bits of 0.
-      if (nbits_ == 0) {
-	    nbits_ = 8;
-	    bits_ = new V [nbits_];
-	    bits_[0] = V0;
-	    bits_[1] = V0;
-	    bits_[2] = V0;
-	    bits_[3] = V0;
-	    bits_[4] = V0;
-	    bits_[5] = V0;
-	    bits_[6] = V0;
-	    bits_[7] = V0;
+      if (str.length() == 0) {
+	    alloc_(8);
 	    return;
       }
 
-      bits_ = new V [nbits_];
+      alloc_(str.length() * 8);
 
+	// The first character of the string is the most significant
+	// byte of the value.
       unsigned idx, cp;
-      V*bp = bits_+nbits_;
       for (idx = nbits_, cp = 0 ;  idx > 0 ;  idx -= 8, cp += 1) {
-	    char ch = str[cp];
-	    *(--bp) = (ch&0x80) ? V1 : V0;
-	    *(--bp) = (ch&0x40) ? V1 : V0;
-	    *(--bp) = (ch&0x20) ? V1 : V0;
-	    *(--bp) = (ch&0x10) ? V1 : V0;
-	    *(--bp) = (ch&0x08) ? V1 : V0;
-	    *(--bp) = (ch&0x04) ? V1 : V0;
-	    *(--bp) = (ch&0x02) ? V1 : V0;
-	    *(--bp) = (ch&0x01) ? V1 : V0;
+	    unsigned char ch = str[cp];
+	    set_bits(idx-8, 8, ch, 0);
       }
 }
 
 verinum::verinum(verinum::V val, unsigned n, bool h)
 : has_len_(h), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = n;
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = val;
+      alloc_(n);
+      fill_(val);
 }
 
 verinum::verinum(uint64_t val, unsigned n)
 : has_len_(true), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = n;
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    bits_[idx] = (val&1) ? V1 : V0;
-	    val >>= (uint64_t)1;
+      alloc_(n);
+      if (n > 0) {
+	    bits_[0] = val;
+	    mask_top_();
       }
 }
 
@@ -182,9 +250,8 @@ verinum::verinum(double val, bool)
 
 	/* We return `bx for a NaN or +/- infinity. */
       if (val != val || (val && (val == 0.5*val))) {
-	    nbits_ = 1;
-	    bits_ = new V[nbits_];
-	    bits_[0] = Vx;
+	    alloc_(1);
+	    set(0, Vx);
 	    return;
       }
 
@@ -200,15 +267,14 @@ verinum::verinum(double val, bool)
 
 	/* Get the exponent and fractional part of the number. */
       fraction = frexp(val, &exponent);
-      nbits_ = exponent+1;
-      bits_ = new V[nbits_];
+      alloc_(exponent+1);
 
 	/* If the value is small enough just use lround(). */
       if (nbits_ <= BITS_IN_LONG) {
 	    long sval = lround(val);
 	    if (is_neg) sval = -sval;
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  bits_[idx] = (sval&1) ? V1 : V0;
+		  set(idx, (sval&1) ? V1 : V0);
 		  sval >>= 1;
 	    }
 	      /* Trim the result. */
@@ -224,7 +290,7 @@ verinum::verinum(double val, bool)
 	    unsigned long bits = (unsigned long) fraction;
 	    fraction = fraction - (double) bits;
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  bits_[idx] = (bits&1) ? V1 : V0;
+		  set(idx, (bits&1) ? V1 : V0);
 		  bits >>= 1;
 	    }
       } else {
@@ -234,7 +300,7 @@ verinum::verinum(double val, bool)
 		  unsigned max_idx = (wd+1)*BITS_IN_LONG;
 		  if (max_idx > nbits_) max_idx = nbits_;
 		  for (unsigned idx = wd*BITS_IN_LONG; idx < max_idx; idx += 1) {
-			bits_[idx] = (bits&1) ? V1 : V0;
+			set(idx, (bits&1) ? V1 : V0);
 			bits >>= 1;
 		  }
 		  fraction = ldexp(fraction, BITS_IN_LONG);
@@ -257,43 +323,39 @@ void verinum::signed_trim()
 {
 	/* Do we have any extra digits? */
       unsigned tlen = nbits_-1;
-      verinum::V sign = bits_[tlen];
-      while ((tlen > 0) && (bits_[tlen] == sign)) tlen -= 1;
+      verinum::V sign = get(tlen);
+      while ((tlen > 0) && (get(tlen) == sign)) tlen -= 1;
 
 	/* tlen now points to the first digit that is not the sign.
 	 * or bit 0. Set the length to include this bit and one proper
 	 * sign bit if needed. */
-      if (bits_[tlen] != sign) tlen += 1;
+      if (get(tlen) != sign) tlen += 1;
       tlen += 1;
 
 	/* Trim the bits if needed. */
       if (tlen < nbits_) {
-	    V* tbits = new V[tlen];
-	    for (unsigned idx = 0; idx < tlen; idx += 1)
-		  tbits[idx] = bits_[idx];
+	    verinum tmp = *this;
 	    delete[] bits_;
-	    bits_ = tbits;
-	    nbits_ = tlen;
+	    alloc_(tlen);
+	    copy_bits(*this, 0, tmp, 0, tlen);
       }
 }
 
 verinum::verinum(const verinum&that)
 {
       string_flag_ = that.string_flag_;
-      nbits_ = that.nbits_;
-      bits_ = new V[nbits_];
+      alloc_(that.nbits_);
       has_len_ = that.has_len_;
       has_sign_ = that.has_sign_;
       is_single_ = that.is_single_;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
+      for (unsigned idx = 0 ;  idx < 2*nwords_(nbits_) ;  idx += 1)
 	    bits_[idx] = that.bits_[idx];
 }
 
 verinum::verinum(const verinum&that, unsigned nbits)
 {
       string_flag_ = that.string_flag_ && (that.nbits_ == nbits);
-      nbits_ = nbits;
-      bits_ = new V[nbits_];
+      alloc_(nbits);
       has_len_ = true;
       has_sign_ = that.has_sign_;
       is_single_ = false;
@@ -301,18 +363,14 @@ verinum::verinum(const verinum&that, unsigned nbits)
       unsigned copy = nbits;
       if (copy > that.nbits_)
 	    copy = that.nbits_;
-      for (unsigned idx = 0 ;  idx < copy ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
 
-      if (copy < nbits_) {
-	    if (has_sign_ || that.is_single_) {
-		  for (unsigned idx = copy ;  idx < nbits_ ;  idx += 1)
-			bits_[idx] = bits_[idx-1];
-	    } else {
-		  for (unsigned idx = copy ;  idx < nbits_ ;  idx += 1)
-			bits_[idx] = verinum::V0;
-	    }
-      }
+	// Extend with the top copied bit if the source is signed,
+	// otherwise with zeros.
+      V pad = V0;
+      if (copy > 0 && copy < nbits_ && (has_sign_ || that.is_single_))
+	    pad = that.get(copy-1);
+
+      copy_bits(*this, 0, that, 0, nbits_, pad);
 }
 
 verinum::verinum(int64_t that)
@@ -322,17 +380,17 @@ verinum::verinum(int64_t that)
 
       if (that < 0) tmp = (that+1)/2;
       else tmp = that/2;
-      nbits_ = 1;
+      unsigned nbits = 1;
       while (tmp != 0) {
-	    nbits_ += 1;
+	    nbits += 1;
 	    tmp /= 2;
       }
 
-      nbits_ += 1;
+      nbits += 1;
 
-      bits_ = new V[nbits_];
+      alloc_(nbits);
       for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    bits_[idx] = (that & 1)? V1 : V0;
+	    set(idx, (that & 1)? V1 : V0);
 	    that >>= 1;
       }
 }
@@ -347,10 +405,9 @@ verinum& verinum::operator= (const verinum&that)
       if (this == &that) return *this;
       if (nbits_ != that.nbits_) {
             delete[]bits_;
-            nbits_ = that.nbits_;
-            bits_ = new V[that.nbits_];
+            alloc_(that.nbits_);
       }
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
+      for (unsigned idx = 0 ;  idx < 2*nwords_(nbits_) ;  idx += 1)
 	    bits_[idx] = that.bits_[idx];
 
       has_len_ = that.has_len_;
@@ -363,42 +420,90 @@ verinum& verinum::operator= (const verinum&that)
 verinum::V verinum::get(unsigned idx) const
 {
       assert(idx < nbits_);
-      return bits_[idx];
+      unsigned nwords = nwords_(nbits_);
+      unsigned abit = (bits_[idx/64] >> (idx%64)) & 1;
+      unsigned bbit = (bits_[nwords + idx/64] >> (idx%64)) & 1;
+      return (V) (abit | (bbit << 1));
 }
 
 verinum::V verinum::set(unsigned idx, verinum::V val)
 {
       assert(idx < nbits_);
-      return bits_[idx] = val;
+      unsigned nwords = nwords_(nbits_);
+      uint64_t mask = (uint64_t)1 << (idx%64);
+      uint64_t&abits = bits_[idx/64];
+      uint64_t&bbits = bits_[nwords + idx/64];
+      abits = (val & 1)? (abits | mask) : (abits & ~mask);
+      bbits = (val & 2)? (bbits | mask) : (bbits & ~mask);
+      return val;
 }
 
-void verinum::set(unsigned off, const verinum&val)
+void verinum::get_bits(unsigned off, uint64_t&abits, uint64_t&bbits,
+		       V pad) const
 {
-      assert(off + val.len() <= nbits_);
-      for (unsigned idx = 0 ; idx < val.len() ; idx += 1)
-	    bits_[off+idx] = val[idx];
+      uint64_t apad = pad_word(pad & 1);
+      uint64_t bpad = pad_word(pad & 2);
+      if (off >= nbits_) {
+	    abits = apad;
+	    bbits = bpad;
+	    return;
+      }
+
+      unsigned nwords = nwords_(nbits_);
+      unsigned wdx = off / 64;
+      unsigned sft = off % 64;
+      abits = bits_[wdx] >> sft;
+      bbits = bits_[nwords + wdx] >> sft;
+      if (sft && (wdx+1 < nwords)) {
+	    abits |= bits_[wdx+1] << (64-sft);
+	    bbits |= bits_[nwords + wdx+1] << (64-sft);
+      }
+
+      unsigned avail = nbits_ - off;
+      if (avail < 64) {
+	    uint64_t mask = low_mask(avail);
+	    abits = (abits & mask) | (apad & ~mask);
+	    bbits = (bbits & mask) | (bpad & ~mask);
+      }
 }
 
-unsigned verinum::as_unsigned() const
+void verinum::set_bits(unsigned off, unsigned cnt,
+		       uint64_t abits, uint64_t bbits)
 {
-      if (nbits_ == 0)
-	    return 0;
+      if (cnt == 0)
+	    return;
 
-      if (!is_defined())
-	    return 0;
+      assert(cnt <= 64);
+      assert(off + cnt <= nbits_);
 
-      unsigned val = 0;
-      unsigned mask = 1;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1) {
-		  if (mask == 0) return ~mask;
-		  val |= mask;
-	    }
+      unsigned nwords = nwords_(nbits_);
+      uint64_t mask = low_mask(cnt);
+      abits &= mask;
+      bbits &= mask;
 
-      return val;
+      unsigned wdx = off / 64;
+      unsigned sft = off % 64;
+      bits_[wdx] = (bits_[wdx] & ~(mask << sft)) | (abits << sft);
+      bits_[nwords+wdx] = (bits_[nwords+wdx] & ~(mask << sft)) | (bbits << sft);
+
+      if (sft && (sft + cnt > 64)) {
+	    unsigned rsft = 64 - sft;
+	    bits_[wdx+1] = (bits_[wdx+1] & ~(mask >> rsft)) | (abits >> rsft);
+	    bits_[nwords+wdx+1] = (bits_[nwords+wdx+1] & ~(mask >> rsft)) | (bbits >> rsft);
+      }
 }
 
-unsigned long verinum::as_ulong() const
+void verinum::set(unsigned off, const verinum&val)
+{
+      assert(off + val.len() <= nbits_);
+      copy_bits(*this, off, val, 0, val.len());
+}
+
+/*
+ * Return the value as an unsigned integer of wid bits. If any higher
+ * bits are set, return the maximum value instead.
+ */
+uint64_t verinum::as_uint_bits_(unsigned wid) const
 {
       if (nbits_ == 0)
 	    return 0;
@@ -406,34 +511,30 @@ unsigned long verinum::as_ulong() const
       if (!is_defined())
 	    return 0;
 
-      unsigned long val = 0;
-      unsigned long mask = 1;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1) {
-		  if (mask == 0) return ~mask;
-		  val |= mask;
-	    }
+      uint64_t max_val = low_mask(wid);
+      unsigned nwords = nwords_(nbits_);
+      for (unsigned idx = 1 ;  idx < nwords ;  idx += 1)
+	    if (bits_[idx] != 0) return max_val;
 
-      return val;
+      if (bits_[0] & ~max_val)
+	    return max_val;
+
+      return bits_[0];
 }
 
-uint64_t verinum::as_ulong64() const
+unsigned verinum::as_unsigned() const
 {
-      if (nbits_ == 0)
-	    return 0;
-
-      if (!is_defined())
-	    return 0;
+      return as_uint_bits_(8 * sizeof(unsigned));
+}
 
-      uint64_t val = 0;
-      uint64_t mask = 1;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1) {
-		  if (mask == 0) return ~mask;
-		  val |= mask;
-	    }
+unsigned long verinum::as_ulong() const
+{
+      return as_uint_bits_(8 * sizeof(unsigned long));
+}
 
-      return val;
+uint64_t verinum::as_ulong64() const
+{
+      return as_uint_bits_(64);
 }
 
 /*
@@ -466,26 +567,26 @@ signed long verinum::as_long() const
       }
       int lost_bits=0;
 
-      if (has_sign_ && (bits_[nbits_-1] == V1)) {
+      if (has_sign_ && (get(nbits_-1) == V1)) {
 	    val = -1;
 	    signed long mask = ~1L;
 	    for (unsigned idx = 0 ;  idx < top ;  idx += 1) {
-		  if (bits_[idx] == V0) val &= mask;
+		  if (get(idx) == V0) val &= mask;
 		  mask = (mask << 1) | 1L;
 	    }
 	    if (diag_top) {
 		  for (unsigned idx = top; idx < diag_top; idx += 1) {
-			if (bits_[idx] == V0) lost_bits=1;
+			if (get(idx) == V0) lost_bits=1;
 		  }
 	    }
       } else {
 	    signed long mask = 1;
 	    for (unsigned idx = 0 ;  idx < top ;  idx += 1, mask <<= 1) {
-		  if (bits_[idx] == V1) val |= mask;
+		  if (get(idx) == V1) val |= mask;
 	    }
 	    if (diag_top) {
 		  for (unsigned idx = top; idx < diag_top; idx += 1) {
-			if (bits_[idx] == V1) lost_bits=1;
+			if (get(idx) == V1) lost_bits=1;
 		  }
 	    }
       }
@@ -502,17 +603,17 @@ double verinum::as_double() const
 
       double val = 0.0;
         /* Do we have/want a signed value? */
-      if (has_sign_ && bits_[nbits_-1] == V1) {
+      if (has_sign_ && get(nbits_-1) == V1) {
 	    V carry = V1;
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  V sum = add_with_carry(~bits_[idx], V0, carry);
+		  V sum = add_with_carry(~get(idx), V0, carry);
 		  if (sum == V1)
 			val += pow(2.0, (double)idx);
 	    }
 	    val *= -1.0;
       } else {
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  if (bits_[idx] == V1)
+		  if (get(idx) == V1)
 			val += pow(2.0, (double)idx);
 	    }
       }
@@ -527,17 +628,11 @@ string verinum::as_string() const
 
       string res;
       for (unsigned idx = nbits_ ;  idx > 0 ;  idx -= 8) {
-	    char char_val = 0;
-	    V*bp = bits_+idx;
-
-	    if (*(--bp) == V1) char_val |= 0x80;
-	    if (*(--bp) == V1) char_val |= 0x40;
-	    if (*(--bp) == V1) char_val |= 0x20;
-	    if (*(--bp) == V1) char_val |= 0x10;
-	    if (*(--bp) == V1) char_val |= 0x08;
-	    if (*(--bp) == V1) char_val |= 0x04;
-	    if (*(--bp) == V1) char_val |= 0x02;
-	    if (*(--bp) == V1) char_val |= 0x01;
+	    uint64_t abits, bbits;
+	    get_bits(idx-8, abits, bbits);
+
+	      // Only the V1 bits are set in the character.
+	    char char_val = (abits & ~bbits) & 0xff;
 
 	    if (char_val == '"' || char_val == '\\') {
 		  char tmp[5];
@@ -559,33 +654,41 @@ bool verinum::is_before(const verinum&that) const
       if (that.nbits_ > nbits_) return true;
       if (that.nbits_ < nbits_) return false;
 
-      for (unsigned idx = nbits_  ;  idx > 0 ;  idx -= 1) {
-	    if (bits_[idx-1] < that.bits_[idx-1]) return true;
-	    if (bits_[idx-1] > that.bits_[idx-1]) return false;
+	// Find the most significant bit that differs, and compare
+	// the V values of that bit.
+      unsigned nwords = nwords_(nbits_);
+      for (unsigned idx = nwords ;  idx > 0 ;  idx -= 1) {
+	    uint64_t diff = (bits_[idx-1] ^ that.bits_[idx-1])
+		  | (bits_[nwords+idx-1] ^ that.bits_[nwords+idx-1]);
+	    if (diff == 0)
+		  continue;
+
+	    unsigned pos = (idx-1)*64 + top_bit(diff);
+	    return get(pos) < that.get(pos);
       }
       return false;
 }
 
 bool verinum::is_defined() const
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    if (bits_[idx] == Vx) return false;
-	    if (bits_[idx] == Vz) return false;
+      unsigned nwords = nwords_(nbits_);
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1) {
+	    if (bits_[nwords+idx] != 0) return false;
       }
       return true;
 }
 
 bool verinum::is_zero() const
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    if (bits_[idx] != V0) return false;
+      for (unsigned idx = 0 ;  idx < 2*nwords_(nbits_) ;  idx += 1)
+	    if (bits_[idx] != 0) return false;
 
       return true;
 }
 
 bool verinum::is_negative() const
 {
-      return (bits_[nbits_-1] == V1) && has_sign();
+      return (get(nbits_-1) == V1) && has_sign();
 }
 
 unsigned verinum::significant_bits() const
@@ -593,11 +696,11 @@ unsigned verinum::significant_bits() const
       unsigned sbits = nbits_;
 
       if (has_sign_) {
-	    V sign_bit = bits_[sbits-1];
-	    while ((sbits > 1) && (bits_[sbits-2] == sign_bit))
+	    V sign_bit = get(sbits-1);
+	    while ((sbits > 1) && (get(sbits-2) == sign_bit))
 		  sbits -= 1;
       } else {
-	    while ((sbits > 1) && (bits_[sbits-1] == verinum::V0))
+	    while ((sbits > 1) && (get(sbits-1) == verinum::V0))
 		  sbits -= 1;
       }
       return sbits;
@@ -605,9 +708,11 @@ unsigned verinum::significant_bits() const
 
 void verinum::cast_to_int2()
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    if (bits_[idx] == Vx || bits_[idx] == Vz)
-		  bits_[idx] = V0;
+	// Vx (10) and Vz (11) both become V0 (00).
+      unsigned nwords = nwords_(nbits_);
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1) {
+	    bits_[idx] &= ~bits_[nwords+idx];
+	    bits_[nwords+idx] = 0;
       }
 }
 
@@ -633,9 +738,7 @@ verinum pad_to_width(const verinum&that, unsigned width)
       }
 
       verinum val(pad, width, that.has_len());
-
-      for (unsigned idx = 0 ;  idx < that.len() ;  idx += 1)
-	    val.set(idx, that[idx]);
+      val.set(0, that);
 
       val.has_sign(that.has_sign());
       if (that.is_string() && (width % 8) == 0) {
@@ -669,9 +772,7 @@ verinum cast_to_width(const verinum&that, unsigned width)
       }
 
       verinum val(pad, width, true);
-
-      for (unsigned idx = 0 ;  idx < that.len() ;  idx += 1)
-	    val.set(idx, that[idx]);
+      val.set(0, that);
 
       val.has_sign(that.has_sign());
       return val;
@@ -736,8 +837,7 @@ verinum trim_vnum(const verinum&that)
 
       verinum tmp (verinum::V0, tlen, false);
       tmp.has_sign(that.has_sign());
-      for (unsigned idx = 0 ;  idx < tmp.len() ;  idx += 1)
-	    tmp.set(idx, that.get(idx));
+      copy_bits(tmp, 0, that, 0, tlen);
 
       return tmp;
 }
@@ -824,6 +924,42 @@ ostream& operator<< (ostream&o, const verinum&v)
       return o;
 }
 
+/*
+ * Find the most significant bit in the range [lo,hi) where the left
+ * and right values differ, or, if check_xz is true, where either
+ * value has an x or z bit. Bits past the end of a value compare as
+ * the pad for that value. Return true and set pos if there is such
+ * a bit.
+ */
+static bool find_top_mismatch(const verinum&left, verinum::V left_pad,
+			      const verinum&right, verinum::V right_pad,
+			      unsigned lo, unsigned hi, bool check_xz,
+			      unsigned&pos)
+{
+      unsigned cur = hi;
+      while (cur > lo) {
+	    unsigned cnt = min(64U, cur - lo);
+	    unsigned off = cur - cnt;
+
+	    uint64_t la, lb, ra, rb;
+	    left.get_bits(off, la, lb, left_pad);
+	    right.get_bits(off, ra, rb, right_pad);
+
+	    uint64_t diff = (la ^ ra) | (lb ^ rb);
+	    if (check_xz)
+		  diff |= lb | rb;
+	    diff &= low_mask(cnt);
+
+	    if (diff != 0) {
+		  pos = off + top_bit(diff);
+		  return true;
+	    }
+	    cur = off;
+      }
+
+      return false;
+}
+
 verinum::V operator == (const verinum&left, const verinum&right)
 {
       verinum::V left_pad = verinum::V0;
@@ -842,17 +978,20 @@ verinum::V operator == (const verinum&left, const verinum&right)
       if (right.len() > max_len)
 	    max_len = right.len();
 
-      for (unsigned idx = 0 ;  idx < max_len ;  idx += 1) {
-	    verinum::V left_bit  = idx < left.len() ? left[idx]  : left_pad;
-	    verinum::V right_bit = idx < right.len()? right[idx] : right_pad;
-	    if (left_bit != right_bit)
-		  return verinum::V0;
-      }
+      unsigned pos;
+      if (find_top_mismatch(left, left_pad, right, right_pad,
+			    0, max_len, false, pos))
+	    return verinum::V0;
 
       return verinum::V1;
 }
 
-verinum::V operator <= (const verinum&left, const verinum&right)
+/*
+ * This implements the <= and < operators. The or_equal flag selects
+ * the result if the values are equal.
+ */
+static verinum::V compare_less(const verinum&left, const verinum&right,
+			       bool or_equal)
 {
       verinum::V left_pad = verinum::V0;
       verinum::V right_pad = verinum::V0;
@@ -867,90 +1006,48 @@ verinum::V operator <= (const verinum&left, const verinum&right)
 		  return verinum::V0;
       }
 
-      unsigned idx;
-      for (idx = left.len() ; idx > right.len() ;  idx -= 1) {
-	    if (left[idx-1] != right_pad) {
-		      // A change of padding for a negative left argument
-		      // denotes the left value is less than the right.
-		   return (signed_calc &&
-		           (left_pad == verinum::V1)) ? verinum::V1 :
-		                                        verinum::V0;
-	    }
-      }
-
-      for (idx = right.len() ; idx > left.len() ;  idx -= 1) {
-	    if (right[idx-1] != left_pad) {
-		      // A change of padding for a negative right argument
-		      // denotes the left value is not less than the right.
-		   return (signed_calc &&
-		           (right_pad == verinum::V1)) ? verinum::V0 :
-		                                         verinum::V1;
-	    }
+      unsigned min_len = min(left.len(), right.len());
+      unsigned max_len = max(left.len(), right.len());
+      unsigned pos;
+
+	// Look at the bits of the longer value that extend past the
+	// shorter value. A change of padding for a negative argument
+	// denotes that argument is the lesser value.
+      if (find_top_mismatch(left, left_pad, right, right_pad,
+			    min_len, max_len, false, pos)) {
+	    if (left.len() > right.len())
+		  return (signed_calc &&
+			  (left_pad == verinum::V1)) ? verinum::V1 :
+			                               verinum::V0;
+	    else
+		  return (signed_calc &&
+			  (right_pad == verinum::V1)) ? verinum::V0 :
+			                                verinum::V1;
+      }
+
+      if (find_top_mismatch(left, left_pad, right, right_pad,
+			    0, min_len, true, pos)) {
+	    verinum::V left_bit = left[pos];
+	    verinum::V right_bit = right[pos];
+	    if (left_bit == verinum::Vx) return verinum::Vx;
+	    if (left_bit == verinum::Vz) return verinum::Vx;
+	    if (right_bit == verinum::Vx) return verinum::Vx;
+	    if (right_bit == verinum::Vz) return verinum::Vx;
+	    if (left_bit > right_bit) return verinum::V0;
+	    return verinum::V1;
       }
 
-      idx = right.len();
-      if (left.len() < idx) idx = left.len();
-
-      while (idx > 0) {
-	    if (left[idx-1] == verinum::Vx) return verinum::Vx;
-	    if (left[idx-1] == verinum::Vz) return verinum::Vx;
-	    if (right[idx-1] == verinum::Vx) return verinum::Vx;
-	    if (right[idx-1] == verinum::Vz) return verinum::Vx;
-	    if (left[idx-1] > right[idx-1]) return verinum::V0;
-	    if (left[idx-1] < right[idx-1]) return verinum::V1;
-	    idx -= 1;
-      }
+      return or_equal? verinum::V1 : verinum::V0;
+}
 
-      return verinum::V1;
+verinum::V operator <= (const verinum&left, const verinum&right)
+{
+      return compare_less(left, right, true);
 }
 
 verinum::V operator < (const verinum&left, const verinum&right)
 {
-      verinum::V left_pad = verinum::V0;
-      verinum::V right_pad = verinum::V0;
-      bool signed_calc = left.has_sign() && right.has_sign();
-      if (signed_calc) {
-	    left_pad = left.get(left.len()-1);
-	    right_pad = right.get(right.len()-1);
-
-	    if (left_pad == verinum::V1 && right_pad == verinum::V0)
-		  return verinum::V1;
-	    if (left_pad == verinum::V0 && right_pad == verinum::V1)
-		  return verinum::V0;
-      }
-
-      unsigned idx;
-      for (idx = left.len() ; idx > right.len() ;  idx -= 1) {
-	    if (left[idx-1] != right_pad) {
-		      // A change of padding for a negative left argument
-		      // denotes the left value is less than the right.
-		   return (signed_calc &&
-		           (left_pad == verinum::V1)) ? verinum::V1 :
-		                                        verinum::V0;
-	    }
-      }
-
-      for (idx = right.len() ; idx > left.len() ;  idx -= 1) {
-	    if (right[idx-1] != left_pad) {
-		      // A change of padding for a negative right argument
-		      // denotes the left value is not less than the right.
-		   return (signed_calc &&
-		           (right_pad == verinum::V1)) ? verinum::V0 :
-		                                         verinum::V1;
-	    }
-      }
-
-      while (idx > 0) {
-	    if (left[idx-1] == verinum::Vx) return verinum::Vx;
-	    if (left[idx-1] == verinum::Vz) return verinum::Vx;
-	    if (right[idx-1] == verinum::Vx) return verinum::Vx;
-	    if (right[idx-1] == verinum::Vz) return verinum::Vx;
-	    if (left[idx-1] > right[idx-1]) return verinum::V0;
-	    if (left[idx-1] < right[idx-1]) return verinum::V1;
-	    idx -= 1;
-      }
-
-      return verinum::V0;
+      return compare_less(left, right, false);
 }
 
 static verinum::V add_with_carry(verinum::V l, verinum::V r, verinum::V&c)
@@ -1003,36 +1100,54 @@ static verinum::V add_with_carry(verinum::V l, verinum::V r, verinum::V&c)
 
 verinum operator ~ (const verinum&left)
 {
+	// V0 and V1 are inverted, and Vx and Vz become Vx (10).
       verinum val = left;
-      for (unsigned idx = 0 ;  idx < val.len() ;  idx += 1)
-	    switch (val[idx]) {
-		case verinum::V0:
-		  val.set(idx, verinum::V1);
-		  break;
-		case verinum::V1:
-		  val.set(idx, verinum::V0);
-		  break;
-		default:
-		  val.set(idx, verinum::Vx);
-		  break;
-	    }
+      for (unsigned idx = 0 ;  idx < val.len() ;  idx += 64) {
+	    uint64_t abits, bbits;
+	    left.get_bits(idx, abits, bbits);
+	    val.set_bits(idx, min(64U, val.len()-idx), ~abits & ~bbits, bbits);
+      }
 
       return val;
 }
 
 /*
- * Addition and subtraction works a bit at a time, from the least
+ * Addition and subtraction works a word at a time, from the least
  * significant up to the most significant. The result is signed only
  * if both of the operands are signed. If either operand is unsized,
  * the result is expanded as needed to prevent overflow.
+ *
+ * The operands are known to be fully defined, so only the a plane
+ * needs to be calculated. The sum is calculated one bit wider than
+ * the widest operand to check for overflow.
  */
+static verinum add_words(const verinum&left, const verinum&right,
+			 bool invert_right, unsigned len)
+{
+      verinum result (verinum::V0, len);
+
+      verinum::V rpad = sign_bit(right);
+      verinum::V lpad = sign_bit(left);
+
+      uint64_t carry = invert_right? 1 : 0;
+      for (unsigned idx = 0 ;  idx < len ;  idx += 64) {
+	    uint64_t la, lb, ra, rb;
+	    left.get_bits(idx, la, lb, lpad);
+	    right.get_bits(idx, ra, rb, rpad);
+	    if (invert_right)
+		  ra = ~ra;
+	    uint64_t sum = add_word(la, ra, carry);
+	    result.set_bits(idx, min(64U, len-idx), sum, 0);
+      }
+
+      return result;
+}
 
 verinum operator + (const verinum&left, const verinum&right)
 {
       const bool has_len_flag = left.has_len() && right.has_len();
       const bool signed_flag = left.has_sign() && right.has_sign();
 
-      unsigned min_len = min(left.len(), right.len());
       unsigned max_len = max(left.len(), right.len());
 
 	// If either the left or right values are undefined, the
@@ -1044,40 +1159,20 @@ verinum operator + (const verinum&left, const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[max_len+1];
-
-      verinum::V carry = verinum::V0;
-      for (unsigned idx = 0 ;  idx < min_len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(left[idx], right[idx], carry);
-
-      verinum::V rpad = sign_bit(right);
-      verinum::V lpad = sign_bit(left);
-
-      if (left.len() > right.len()) {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(left[idx], rpad, carry);
-
-      } else {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(lpad, right[idx], carry);
-      }
+      verinum val = add_words(left, right, false, max_len+1);
 
       unsigned len = max_len;
       if (!has_len_flag) {
-	    val_bits[max_len] = add_with_carry(lpad, rpad, carry);
 	    if (signed_flag) {
-		  if (val_bits[max_len] != val_bits[max_len-1]) len += 1;
+		  if (val[max_len] != val[max_len-1]) len += 1;
 	    } else {
-		  if (val_bits[max_len] != verinum::V0) len += 1;
+		  if (val[max_len] != verinum::V0) len += 1;
 	    }
       }
-      verinum result (val_bits, len, has_len_flag);
+      verinum result (val, len);
+      result.has_len(has_len_flag);
       result.has_sign(signed_flag);
 
-      delete[]val_bits;
-
       return result;
 }
 
@@ -1086,7 +1181,6 @@ verinum operator - (const verinum&left, const verinum&right)
       const bool has_len_flag = left.has_len() && right.has_len();
       const bool signed_flag = left.has_sign() && right.has_sign();
 
-      unsigned min_len = min(left.len(), right.len());
       unsigned max_len = max(left.len(), right.len());
 
 	// If either the left or right values are undefined, the
@@ -1098,36 +1192,16 @@ verinum operator - (const verinum&left, const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[max_len+1];
-
-      verinum::V carry = verinum::V1;
-      for (unsigned idx = 0 ;  idx < min_len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(left[idx], ~right[idx], carry);
-
-      verinum::V rpad = sign_bit(right);
-      verinum::V lpad = sign_bit(left);
-
-      if (left.len() > right.len()) {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(left[idx], ~rpad, carry);
-
-      } else {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(lpad, ~right[idx], carry);
-      }
+      verinum val = add_words(left, right, true, max_len+1);
 
       unsigned len = max_len;
       if (signed_flag && !has_len_flag) {
-	    val_bits[max_len] = add_with_carry(lpad, ~rpad, carry);
-	    if (val_bits[max_len] != val_bits[max_len-1]) len += 1;
+	    if (val[max_len] != val[max_len-1]) len += 1;
       }
-      verinum result (val_bits, len, has_len_flag);
+      verinum result (val, len);
+      result.has_len(has_len_flag);
       result.has_sign(signed_flag);
 
-      delete[]val_bits;
-
       return result;
 }
 
@@ -1146,21 +1220,16 @@ verinum operator - (const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[len+1];
-
-      verinum::V carry = verinum::V1;
-      for (unsigned idx = 0 ;  idx < len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(verinum::V0, ~right[idx], carry);
+      verinum zero (verinum::V0, len);
+      verinum val = add_words(zero, right, true, len+1);
 
       if (signed_flag && !has_len_flag) {
-	    val_bits[len] = add_with_carry(verinum::V0, ~sign_bit(right), carry);
-	    if (val_bits[len] != val_bits[len-1]) len += 1;
+	    if (val[len] != val[len-1]) len += 1;
       }
-      verinum result (val_bits, len, has_len_flag);
+      verinum result (val, len);
+      result.has_len(has_len_flag);
       result.has_sign(signed_flag);
 
-      delete[]val_bits;
-
       return result;
 }
 
@@ -1191,26 +1260,41 @@ verinum operator * (const verinum&left, const verinum&right)
 	    return result;
       }
 
-      verinum result(verinum::V0, len, has_len_flag);
-      result.has_sign(signed_flag);
+	// Split the (sign extended) operands into 32bit digits so
+	// that the digit products fit in a uint64_t.
+      unsigned ndigits = (len + 31) / 32;
+      vector<uint64_t> l_digits (ndigits);
+      vector<uint64_t> r_digits (ndigits);
+      vector<uint64_t> p_digits (ndigits, 0);
 
+      verinum::V l_sign = sign_bit(left);
       verinum::V r_sign = sign_bit(right);
-      for (unsigned rdx = 0 ;  rdx < len ;  rdx += 1) {
+      for (unsigned idx = 0 ;  idx < ndigits ;  idx += 1) {
+	    uint64_t abits, bbits;
+	    left.get_bits(32*idx, abits, bbits, l_sign);
+	    l_digits[idx] = abits & 0xffffffff;
+	    right.get_bits(32*idx, abits, bbits, r_sign);
+	    r_digits[idx] = abits & 0xffffffff;
+      }
 
-	    verinum::V r_bit = rdx < r_len ? right.get(rdx) : r_sign;
-	    if (r_bit == verinum::V0)
+      for (unsigned rdx = 0 ;  rdx < ndigits ;  rdx += 1) {
+	    if (r_digits[rdx] == 0)
 		  continue;
 
-	    verinum::V l_sign = sign_bit(left);
-	    verinum::V carry = verinum::V0;
-	    for (unsigned ldx = 0 ;  ldx < (len - rdx) ;  ldx += 1) {
-		  verinum::V l_bit = ldx < l_len ? left[ldx] : l_sign;
-		  result.set(ldx+rdx, add_with_carry(l_bit,
-						     result[rdx+ldx],
-						     carry));
+	    uint64_t carry = 0;
+	    for (unsigned ldx = 0 ;  ldx < (ndigits - rdx) ;  ldx += 1) {
+		  uint64_t tmp = l_digits[ldx] * r_digits[rdx]
+			+ p_digits[ldx+rdx] + carry;
+		  p_digits[ldx+rdx] = tmp & 0xffffffff;
+		  carry = tmp >> 32;
 	    }
       }
 
+      verinum result(verinum::V0, len, has_len_flag);
+      result.has_sign(signed_flag);
+      for (unsigned idx = 0 ;  idx < ndigits ;  idx += 1)
+	    result.set_bits(32*idx, min(32U, len - 32*idx), p_digits[idx], 0);
+
       return trim_vnum(result);
 }
 
@@ -1314,8 +1398,8 @@ verinum operator << (const verinum&that, unsigned shift)
       verinum result(verinum::V0, len, has_len_flag);
       result.has_sign(that.has_sign());
 
-      for (unsigned idx = shift ;  idx < len ;  idx += 1)
-	    result.set(idx, that.get(idx - shift));
+      if (shift < len)
+	    copy_bits(result, shift, that, 0, len - shift);
 
       return trim_vnum(result);
 }
@@ -1339,8 +1423,7 @@ verinum operator >> (const verinum&that, unsigned shift)
       verinum result(sign_bit, len, has_len_flag);
       result.has_sign(that.has_sign());
 
-      for (unsigned idx = shift ;  idx < that.len() ;  idx += 1)
-	    result.set(idx-shift, that.get(idx));
+      copy_bits(result, 0, that, shift, that.len() - shift);
 
       return trim_vnum(result);
 }
@@ -1576,11 +1659,8 @@ verinum concat(const verinum&left, const verinum&right)
       }
 
       verinum res (verinum::V0, left.len() + right.len());
-      for (unsigned idx = 0 ;  idx < right.len() ;  idx += 1)
-	    res.set(idx, right.get(idx));
-
-      for (unsigned idx = 0 ;  idx < left.len() ;  idx += 1)
-	    res.set(idx+right.len(), left.get(idx));
+      res.set(0, right);
+      res.set(right.len(), left);
 
       return res;
 }
@@ -100,6 +100,16 @@ class verinum {
 
       V operator[] (unsigned idx) const { return get(idx); }
 
+	// The bits can also be accessed 64 at a time. The abits and
+	// bbits words hold bit 0 and bit 1 of the V values of the bits
+	// starting at off, so V0=00, V1=01, Vx=10 and Vz=11. Bits past
+	// the end of the number read as the pad value. The set_bits
+	// method writes cnt (at most 64) bits starting at off.
+      void get_bits(unsigned off, uint64_t&abits, uint64_t&bbits,
+		    V pad =V0) const;
+      void set_bits(unsigned off, unsigned cnt,
+		    uint64_t abits, uint64_t bbits);
+
 	// Return the value as a native unsigned integer. If the value is
 	// larger than can be represented by the returned type, return
 	// the maximum value of that type. If the value has any x or z
@@ -113,9 +123,19 @@ class verinum {
       string as_string() const;
     private:
       void signed_trim();
+      uint64_t as_uint_bits_(unsigned wid) const;
+
+	// The value is stored in two bit planes, each packed into
+	// nwords_(nbits_) words. The a plane is first in bits_, and the
+	// b plane follows it. Bits past nbits_ in the last word of
+	// each plane are always zero.
+      static unsigned nwords_(unsigned nbits) { return (nbits + 63) / 64; }
+      void alloc_(unsigned nbits);
+      void fill_(V val);
+      void mask_top_();
 
     private:
-      V* bits_;
+      uint64_t* bits_;
       unsigned nbits_;
       bool has_len_;
       bool has_sign_;
@@ -91,8 +91,155 @@ struct strobe_cb_info {
       vpiHandle*items;
       unsigned nitems;
       unsigned fd_mcd;
+	/* If not nil, the parsed format plan (or nil) for each item. */
+      struct format_plan**plans;
 };
 
+/*
+ * The display tasks build their output in a display_buf. The text is
+ * not necessarily NUL terminated in the middle since %u and %z can
+ * insert NULL characters, so the size is kept explicitly. The buffer
+ * is kept from call to call, so once it has grown to fit the longest
+ * line displayed no more allocation is needed to format a line.
+ */
+struct display_buf {
+      char*text;
+      unsigned size;
+      unsigned alloc;
+};
+
+static struct display_buf display_out = { 0, 0, 0 };
+
+static void display_reserve(struct display_buf*out, unsigned cnt)
+{
+      if (out->size + cnt + 1 > out->alloc) {
+	    unsigned alloc = out->alloc ? out->alloc : 256;
+	    while (out->size + cnt + 1 > alloc) alloc *= 2;
+	    out->text = realloc(out->text, alloc);
+	    out->alloc = alloc;
+      }
+}
+
+static void display_append(struct display_buf*out, const char*text,
+                           unsigned cnt)
+{
+      display_reserve(out, cnt);
+      memcpy(out->text + out->size, text, cnt);
+      out->size += cnt;
+      out->text[out->size] = '\0';
+}
+
+static void display_fill(struct display_buf*out, char fill, unsigned cnt)
+{
+      display_reserve(out, cnt);
+      memset(out->text + out->size, fill, cnt);
+      out->size += cnt;
+      out->text[out->size] = '\0';
+}
+
+/*
+ * The get_format_char() routine formats each item into this scratch
+ * buffer before appending it to the output. The contents are kept
+ * when the buffer grows.
+ */
+static char*display_scratch_text = 0;
+static unsigned display_scratch_size = 0;
+
+static char*display_scratch(unsigned size)
+{
+      if (size > display_scratch_size) {
+	    display_scratch_text = realloc(display_scratch_text, size);
+	    display_scratch_size = size;
+      }
+      return display_scratch_text;
+}
+
+/*
+ * A format string is parsed once into a format_plan. Each step is a
+ * run of literal text followed by an optional format specification,
+ * so printing with a constant format string does not need to scan
+ * the string again.
+ */
+struct format_step {
+      unsigned text_off;
+      unsigned text_len;
+      int has_spec;
+      int ljust, plus, ld_zero, width, prec;
+      char fmt;
+};
+
+struct format_plan {
+      char*text;
+	/* If set, the argument text may change between calls (it is
+	   a string on the thread stack), so check it against the plan
+	   text before each use. */
+      int recheck;
+      unsigned nsteps;
+      struct format_step*steps;
+};
+
+static struct format_plan* compile_format(const char*fmt)
+{
+      struct format_plan*plan = malloc(sizeof(struct format_plan));
+      char*cp;
+
+      plan->text = strdup(fmt);
+      plan->recheck = 0;
+      plan->nsteps = 0;
+      plan->steps = 0;
+
+      cp = plan->text;
+      while (*cp) {
+	    struct format_step*step;
+	    size_t cnt = strcspn(cp, "%");
+
+	    plan->steps = realloc(plan->steps, (plan->nsteps+1)*
+	                                       sizeof(struct format_step));
+	    step = plan->steps + plan->nsteps;
+	    plan->nsteps += 1;
+
+	    step->text_off = cp - plan->text;
+	    step->text_len = cnt;
+	    step->has_spec = 0;
+	    step->ljust = 0;
+	    step->plus = 0;
+	    step->ld_zero = 0;
+	    step->width = -1;
+	    step->prec = -1;
+	    step->fmt = 0;
+	    cp += cnt;
+	    if (*cp != '%') break;
+
+	    step->has_spec = 1;
+	    cp += 1;
+	    while ((*cp == '-') || (*cp == '+')) {
+		  if (*cp == '-') step->ljust = 1;
+		  else step->plus = 1;
+		  cp += 1;
+	    }
+	    if (*cp == '0') {
+		  step->ld_zero = 1;
+		  cp += 1;
+	    }
+	    if (isdigit((int)*cp)) step->width = strtoul(cp, &cp, 10);
+	    if (*cp == '.') {
+		  cp += 1;
+		  step->prec = strtoul(cp, &cp, 10);
+	    }
+	    step->fmt = *cp;
+	    if (*cp) cp += 1;
+      }
+
+      return plan;
+}
+
+static void free_format_plan(struct format_plan*plan)
+{
+      free(plan->text);
+      free(plan->steps);
+      free(plan);
+}
+
 /*
  * The number of decimal digits needed to represent a
  * nr_bits binary number is floor(nr_bits*log_10(2))+1,
@@ -186,12 +333,11 @@ static int get_default_format(const char *name)
 
 /* Build the format using the variables that control how the item will
  * be printed. This is used in error messages and directly by the e/f/g
- * format codes (minus the enclosing <>). The user needs to free the
- * returned string. */
-static char * format_as_string(int ljust, int plus, int ld_zero, int width,
-                               int prec, char fmt)
+ * format codes (minus the enclosing <>). The buf must hold at least 256
+ * characters. */
+static void format_as_string(char *buf, int ljust, int plus, int ld_zero,
+                             int width, int prec, char fmt)
 {
-  char buf[256];
   unsigned int size = 0;
 
   /* Do not remove/change the "<" without also changing the e/f/g format
@@ -209,7 +355,6 @@ static char * format_as_string(int ljust, int plus, int ld_zero, int width,
   /* The same goes here ">"! */
   buf[size++] = '>';
   buf[size] = '\0';
-  return strdup(buf);
 }
 
 static void get_time(char *rtn, const char *value, int prec,
@@ -291,13 +436,13 @@ static void get_time_real(char *rtn, double value, int prec,
   sprintf(rtn, "%0.*f%s", prec, value, timeformat_info.suff);
 }
 
-static unsigned int get_format_char(char **rtn, int ljust, int plus,
+static unsigned int get_format_char(struct display_buf *out, int ljust, int plus,
                                     int ld_zero, int width, int prec,
                                     char fmt, const struct strobe_cb_info *info,
                                     unsigned int *idx)
 {
   s_vpi_value value;
-  char *result, *fmtb;
+  char *result, fmtb[256];
   unsigned int size;
   unsigned int ini_size = 512;  /* The initial size of the buffer. */
 
@@ -306,8 +451,8 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
   if ((unsigned int)(width+1) > ini_size) ini_size = width + 1;
 
   /* The default return value is the full format. */
-  result = malloc(ini_size*sizeof(char));
-  fmtb = format_as_string(ljust, plus, ld_zero, width, prec, fmt);
+  result = display_scratch(ini_size);
+  format_as_string(fmtb, ljust, plus, ld_zero, width, prec, fmt);
   strcpy(result, fmtb);
   size = strlen(result) + 1; /* fallback value if errors */
   switch (fmt) {
@@ -384,7 +529,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
           /* If the default buffer is too small, make it big enough. */
           size = strlen(cp) + 1;
           if ((signed)size < (width+1)) size = width+1;
-          if (size > ini_size) result = realloc(result, size*sizeof(char));
+          if (size > ini_size) result = display_scratch(size);
 
           if (ljust == 0) sprintf(result, "%*s", width, cp);
           else sprintf(result, "%-*s", width, cp);
@@ -454,15 +599,17 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
           unsigned pad = 0;
           unsigned swidth = strlen(value.value.str) +
                             (value.value.str[0] == '-' ? 0 : (unsigned)plus);
-          char *tbuf, *cpb, *cp = value.value.str;
+          unsigned tsize = swidth + 1;
+          char sbuf[64], *tbuf, *cpb, *cp = value.value.str;
 
-          /* Allocate storage and calculate the pad if needed. */
+          /* Calculate the pad if needed. Most values fit in the local
+           * buffer so only allocate storage for very wide ones. */
           if (ljust == 0 && ld_zero == 1 && (signed)swidth < width) {
-            tbuf = malloc((width+1)*sizeof(char));
+            tsize = width + 1;
             pad = (unsigned)width - swidth;
-          } else {
-            tbuf = malloc((swidth+1)*sizeof(char));
           }
+          if (tsize <= sizeof(sbuf)) tbuf = sbuf;
+          else tbuf = malloc(tsize*sizeof(char));
           cpb = tbuf;
 
           /* Insert the sign if needed. */
@@ -490,11 +637,11 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
           /* If the default buffer is too small make it big enough. */
           size = strlen(tbuf) + 1;
           if ((signed)size < (width+1)) size = width+1;
-          if (size > ini_size) result = realloc(result, size*sizeof(char));
+          if (size > ini_size) result = display_scratch(size);
 
           if (ljust == 0) sprintf(result, "%*s", width, tbuf);
           else sprintf(result, "%-*s", width, tbuf);
-          free(tbuf);
+          if (tbuf != sbuf) free(tbuf);
           size = strlen(result) + 1;
         }
       }
@@ -537,7 +684,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
           size = width + 1;
           if (size < 320) size = 320;
           size += prec;
-          if (size > ini_size) result = realloc(result, size*sizeof(char));
+          if (size > ini_size) result = display_scratch(size);
 #if !defined(__GNUC__)
 		  if (isnan(value.value.real))
 			  sprintf(result, "%s", "nan");
@@ -573,7 +720,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
         /* If the default buffer is too small, make it big enough. */
         size = strlen(cp) + 1;
         if ((signed)size < (width+1)) size = width+1;
-        if (size > ini_size) result = realloc(result, size*sizeof(char));
+        if (size > ini_size) result = display_scratch(size);
 
         if (ljust == 0) sprintf(result, "%*s", width, cp);
         else sprintf(result, "%-*s", width, cp);
@@ -608,7 +755,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
           /* If the default buffer is too small make it big enough. */
           size = strlen(value.value.str) + 1;
           if ((signed)size < (width+1)) size = width+1;
-          if (size > ini_size) result = realloc(result, size*sizeof(char));
+          if (size > ini_size) result = display_scratch(size);
           if (ljust == 0) sprintf(result, "%*s", width, value.value.str);
           else sprintf(result, "%-*s", width, value.value.str);
           size = strlen(result) + 1;
@@ -640,7 +787,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
           vpi_printf("WARNING: %s:%d: incompatible value for %s%s.\n",
                      info->filename, info->lineno, info->name, fmtb);
         } else {
-          char *tbuf, *prev_suff = 0;
+          char sbuf[640], *tbuf, *prev_suff = 0;
           PLI_INT32 time_units = vpi_get(vpiTimeUnit, info->scope);
 
           if (plus != 0) {
@@ -679,7 +826,8 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
            * have an arbitrary value so you can overflow the buffer, but
            * for now we will assume the user will use this as intended
            * (pass a time variable or the result of a time function). */
-          tbuf = malloc((513+suff_len)*sizeof(char));
+          if (513+suff_len <= sizeof(sbuf)) tbuf = sbuf;
+          else tbuf = malloc((513+suff_len)*sizeof(char));
           if (prec == -1) prec = timeformat_info.prec;
           if (value.format == vpiRealVal) {
             get_time_real(tbuf, value.value.real, prec, time_units);
@@ -714,12 +862,12 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
           /* If the default buffer is too small make it big enough. */
           size = strlen(tbuf) + 1;
           if ((signed)size < (width+1)) size = width+1;
-          if (size > ini_size) result = realloc(result, size*sizeof(char));
+          if (size > ini_size) result = display_scratch(size);
 
           if (ljust == 0) sprintf(result, "%*s", width, cp);
           else sprintf(result, "%-*s", width, cp);
           if (free_flag) free(cp);
-          free(tbuf);
+          if (tbuf != sbuf) free(tbuf);
           size = strlen(result) + 1;
         }
       }
@@ -749,7 +897,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
           veclen = (vpi_get(vpiSize, info->items[*idx])+31)/32;
           size = veclen * 4 + 1;
           /* If the default buffer is too small, make it big enough. */
-          if (size > ini_size) result = realloc(result, size*sizeof(char));
+          if (size > ini_size) result = display_scratch(size);
           cp = result;
           for (word = 0; word < veclen; word += 1) {
             PLI_INT32 bits = value.value.vector[word].aval &
@@ -800,7 +948,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
           size = nbits*4;
           rbuf = malloc(size*sizeof(char));
           if ((signed)size < (width+1)) size = width+1;
-          if (size > ini_size) result = realloc(result, size*sizeof(char));
+          if (size > ini_size) result = display_scratch(size);
           strcpy(rbuf, "");
           for (bit = nbits-1; bit >= 0; bit -= 1) {
             vpip_format_strength(tbuf, &value, bit);
@@ -840,7 +988,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
           veclen = (vpi_get(vpiSize, info->items[*idx])+31)/32;
           size = 2 * veclen * 4 + 1;
           /* If the default buffer is too small, make it big enough. */
-          if (size > ini_size) result = realloc(result, size*sizeof(char));
+          if (size > ini_size) result = display_scratch(size);
           cp = result;
           for (word = 0; word < veclen; word += 1) {
             /* Write the aval followed by the bval in endian order. */
@@ -869,66 +1017,48 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
       size = strlen(result) + 1;
       break;
   }
-  free(fmtb);
-  /* We can't use strdup here since %u and %z can insert NULL
+  /* We can't use strcpy here since %u and %z can insert NULL
    * characters into the stream. */
-  *rtn = malloc(size*sizeof(char));
-  memcpy(*rtn, result, size);
-  free(result);
+  display_append(out, result, size - 1);
   return size - 1;
 }
 
-/* We can't use the normal str functions on the return value since
- * %u and %z can insert NULL characters into the stream. */
-static unsigned int get_format(char **rtn, char *fmt,
-                               const struct strobe_cb_info *info, unsigned int *idx)
+/* Append the text for a parsed format to the output. We can't use the
+ * normal str functions on the result since %u and %z can insert NULL
+ * characters into the stream. */
+static unsigned int run_format(struct display_buf *out,
+                               const struct format_plan *plan,
+                               const struct strobe_cb_info *info,
+                               unsigned int *idx)
 {
-  char *cp = fmt;
-  unsigned int size;
+  unsigned int size = 0, step;
 
-  *rtn = strdup("");
-  size = 1;
-  while (*cp) {
-    size_t cnt = strcspn(cp, "%");
+  for (step = 0; step < plan->nsteps; step += 1) {
+    const struct format_step *cur = plan->steps + step;
 
-    if (cnt > 0) {
-      *rtn = realloc(*rtn, (size+cnt)*sizeof(char));
-      memcpy(*rtn+size-1, cp, cnt);
-      size += cnt;
-      cp += cnt;
-    } else {
-      int ljust = 0, plus = 0, ld_zero = 0, width = -1, prec = -1;
-      char *result;
-
-      cp += 1;
-      while ((*cp == '-') || (*cp == '+')) {
-        if (*cp == '-') ljust = 1;
-        else plus = 1;
-        cp += 1;
-      }
-      if (*cp == '0') {
-        ld_zero = 1;
-        cp += 1;
-      }
-      if (isdigit((int)*cp)) width = strtoul(cp, &cp, 10);
-      if (*cp == '.') {
-        cp += 1;
-        prec = strtoul(cp, &cp, 10);
-      }
-      cnt = get_format_char(&result, ljust, plus, ld_zero, width, prec, *cp,
-                            info, idx);
-      *rtn = realloc(*rtn, (size+cnt)*sizeof(char));
-      memcpy(*rtn+size-1, result, cnt);
-      free(result);
-      size += cnt;
-      if (*cp) cp += 1;
+    display_append(out, plan->text + cur->text_off, cur->text_len);
+    size += cur->text_len;
+    if (cur->has_spec) {
+      size += get_format_char(out, cur->ljust, cur->plus, cur->ld_zero,
+                              cur->width, cur->prec, cur->fmt, info, idx);
     }
   }
-  *(*rtn+size-1) = '\0';
-  return size - 1;
+  return size;
 }
 
-static unsigned int get_numeric(char **rtn, const struct strobe_cb_info *info,
+/* Parse and run a format string that is only used once. */
+static unsigned int get_format(struct display_buf *out, const char *fmt,
+                               const struct strobe_cb_info *info,
+                               unsigned int *idx)
+{
+  struct format_plan *plan = compile_format(fmt);
+  unsigned int size = run_format(out, plan, info, idx);
+  free_format_plan(plan);
+  return size;
+}
+
+static unsigned int get_numeric(struct display_buf *out,
+                                const struct strobe_cb_info *info,
                                 vpiHandle item)
 {
   int size, min;
@@ -937,39 +1067,95 @@ static unsigned int get_numeric(char **rtn, const struct strobe_cb_info *info,
   val.format = info->default_format;
   vpi_get_value(item, &val);
 
+  min = strlen(val.value.str);
   switch(info->default_format){
     case vpiDecStrVal:
       size = vpi_get_dec_size(item);
 	/* -1 can be represented as a one bit signed value. This returns
 	 * a size of 1 which is too small for the -1 string value so make
 	 * the string width the minimum display width. */
-      min = strlen(val.value.str);
       if (size < min) size = min;
-      *rtn = malloc((size+1)*sizeof(char));
-      sprintf(*rtn, "%*s", size, val.value.str);
+      display_fill(out, ' ', size - min);
+      display_append(out, val.value.str, min);
       break;
     default:
-      *rtn = strdup(val.value.str);
+      size = min;
+      display_append(out, val.value.str, size);
   }
 
-  return strlen(*rtn);
+  return size;
 }
 
-/* In many places we can't use the normal str functions since %u and %z
- * can insert NULL characters into the stream. */
+/* Append the text of a real value in the default format. */
+static unsigned int get_real_default(struct display_buf *out, double real)
+{
+  char buf[256];
+  unsigned int width;
+
+#if !defined(__GNUC__)
+  if (compatible_flag)
+    sprintf(buf, "%g", real);
+  else {
+    if (real == 0.0 || real == -0.0)
+      sprintf(buf, "%.05f", real);
+    else
+      sprintf(buf, "%#g", real);
+  }
+#else
+  sprintf(buf, compatible_flag ? "%g" : "%#g", real);
+#endif
+  width = strlen(buf);
+  display_append(out, buf, width);
+  return width;
+}
+
+/* Append the text of a string padded on the left to at least width
+ * characters. */
+static unsigned int get_padded(struct display_buf *out, const char *str,
+                               unsigned int width)
+{
+  unsigned int len = strlen(str);
+
+  if (len >= width) width = len;
+  display_fill(out, ' ', width - len);
+  display_append(out, str, len);
+  return width;
+}
+
+/* Format all the items into the shared display buffer and return the
+ * text. The text is only valid until the next call and must not be
+ * freed. In many places we can't use the normal str functions since %u
+ * and %z can insert NULL characters into the stream. */
 static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
 {
-  char *result, *fmt, *rtn, *func_name;
-  const char *cresult;
+  struct display_buf *out = &display_out;
+  char *func_name;
   s_vpi_value value;
-  unsigned int idx, size, width;
+  unsigned int idx;
   char buf[256];
 
-  rtn = strdup("");
-  size = 1;
+  out->size = 0;
+  display_append(out, "", 0);
   for  (idx = 0; idx < info->nitems; idx += 1) {
     vpiHandle item = info->items[idx];
 
+      /* A constant format string that was parsed ahead of time. */
+    if (info->plans && info->plans[idx]) {
+      struct format_plan *plan = info->plans[idx];
+      if (plan->recheck) {
+        value.format = vpiStringVal;
+        vpi_get_value(item, &value);
+        if (strcmp(value.value.str, plan->text) != 0) {
+          free_format_plan(plan);
+          plan = compile_format(value.value.str);
+          plan->recheck = 1;
+          info->plans[idx] = plan;
+        }
+      }
+      run_format(out, plan, info, &idx);
+      continue;
+    }
+
     switch (vpi_get(vpiType, item)) {
 
       case vpiConstant:
@@ -977,32 +1163,14 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
         if (vpi_get(vpiConstType, item) == vpiStringConst) {
           value.format = vpiStringVal;
           vpi_get_value(item, &value);
-          fmt = strdup(value.value.str);
-          width = get_format(&result, fmt, info, &idx);
-          free(fmt);
+          get_format(out, value.value.str, info, &idx);
         } else if (vpi_get(vpiConstType, item) == vpiRealConst) {
           value.format = vpiRealVal;
           vpi_get_value(item, &value);
-#if !defined(__GNUC__)
-		  if (compatible_flag)
-			  sprintf(buf, "%g", value.value.real);
-		  else {
-			  if (value.value.real == 0.0 || value.value.real == -0.0)
-				  sprintf(buf, "%.05f", value.value.real);
-			  else
-				  sprintf(buf, "%#g", value.value.real);
-		  }
-#else
-          sprintf(buf, compatible_flag ? "%g" : "%#g", value.value.real);
-#endif
-          result = strdup(buf);
-          width = strlen(result);
+          get_real_default(out, value.value.real);
         } else {
-          width = get_numeric(&result, info, item);
+          get_numeric(out, info, item);
         }
-        rtn = realloc(rtn, (size+width)*sizeof(char));
-        memcpy(rtn+size-1, result, width);
-        free(result);
         break;
 
       case vpiNet:
@@ -1015,10 +1183,7 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
       case vpiIntegerVar:
       case vpiMemoryWord:
       case vpiPartSelect:
-        width = get_numeric(&result, info, item);
-        rtn = realloc(rtn, (size+width)*sizeof(char));
-        memcpy(rtn+size-1, result, width);
-        free(result);
+        get_numeric(out, info, item);
         break;
 
       /* It appears that this is not currently used! A time variable is
@@ -1029,31 +1194,14 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
         vpi_get_value(item, &value);
         get_time(buf, value.value.str, timeformat_info.prec,
                  vpi_get(vpiTimeUnit, info->scope));
-        width = strlen(buf);
-        if (width  < timeformat_info.width) width = timeformat_info.width;
-        rtn = realloc(rtn, (size+width)*sizeof(char));
-        sprintf(rtn+size-1, "%*s", width, buf);
+        get_padded(out, buf, timeformat_info.width);
         break;
 
       /* Realtime variables are also processed here. */
       case vpiRealVar:
         value.format = vpiRealVal;
         vpi_get_value(item, &value);
-#if !defined(__GNUC__)
-		if (compatible_flag)
-			sprintf(buf, "%g", value.value.real);
-		else {
-			if (value.value.real == 0.0 || value.value.real == -0.0)
-				sprintf(buf, "%.05f", value.value.real);
-			else
-				sprintf(buf, "%#g", value.value.real);
-		}
-#else
-        sprintf(buf, compatible_flag ? "%g" : "%#g", value.value.real);
-#endif
-        width = strlen(buf);
-        rtn = realloc(rtn, (size+width)*sizeof(char));
-        memcpy(rtn+size-1, buf, width);
+        get_real_default(out, value.value.real);
         break;
 
        /* Process string variables like string constants: interpret
@@ -1061,12 +1209,7 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
       case vpiStringVar:
 	value.format = vpiStringVal;
 	vpi_get_value(item, &value);
-	fmt = strdup(value.value.str);
-	width = get_format(&result, fmt, info, &idx);
-	free(fmt);
-        rtn = realloc(rtn, (size+width)*sizeof(char));
-        memcpy(rtn+size-1, result, width);
-        free(result);
+	get_format(out, value.value.str, info, &idx);
 	break;
 
       case vpiSysFuncCall:
@@ -1074,26 +1217,17 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
         if (strcmp(func_name, "$time") == 0) {
           value.format = vpiDecStrVal;
           vpi_get_value(item, &value);
-          width = strlen(value.value.str);
-          if (width  < 20) width = 20;
-          rtn = realloc(rtn, (size+width)*sizeof(char));
-          sprintf(rtn+size-1, "%*s", width, value.value.str);
+          get_padded(out, value.value.str, 20);
 
         } else if (strcmp(func_name, "$stime") == 0) {
           value.format = vpiDecStrVal;
           vpi_get_value(item, &value);
-          width = strlen(value.value.str);
-          if (width  < 10) width = 10;
-          rtn = realloc(rtn, (size+width)*sizeof(char));
-          sprintf(rtn+size-1, "%*s", width, value.value.str);
+          get_padded(out, value.value.str, 10);
 
         } else if (strcmp(func_name, "$simtime") == 0) {
           value.format = vpiDecStrVal;
           vpi_get_value(item, &value);
-          width = strlen(value.value.str);
-          if (width  < 20) width = 20;
-          rtn = realloc(rtn, (size+width)*sizeof(char));
-          sprintf(rtn+size-1, "%*s", width, value.value.str);
+          get_padded(out, value.value.str, 20);
 
         } else if (strcmp(func_name, "$realtime") == 0) {
           /* Use the local scope precision. */
@@ -1103,17 +1237,12 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
           value.format = vpiRealVal;
           vpi_get_value(item, &value);
           sprintf(buf, "%.*f", use_prec, value.value.real);
-          width = strlen(buf);
-          rtn = realloc(rtn, (size+width)*sizeof(char));
-          sprintf(rtn+size-1, "%*s", width, buf);
+          get_padded(out, buf, 0);
 
         } else {
           vpi_printf("WARNING: %s:%d: %s does not support %s as an argument!\n",
                      info->filename, info->lineno, info->name, func_name);
-          strcpy(buf, "<?>");
-          width = strlen(buf);
-          rtn = realloc(rtn, (size+width)*sizeof(char));
-          memcpy(rtn+size-1, buf, width);
+          get_padded(out, "<?>", 0);
         }
         break;
 
@@ -1121,17 +1250,12 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
         vpi_printf("WARNING: %s:%d: unknown argument type (%s) given to %s!\n",
                    info->filename, info->lineno, vpi_get_str(vpiType, item),
                    info->name);
-        cresult = "<?>";
-        width = strlen(cresult);
-        rtn = realloc(rtn, (size+width)*sizeof(char));
-        memcpy(rtn+size-1, cresult, width);
+        get_padded(out, "<?>", 0);
         break;
     }
-    size += width;
   }
-  rtn[size-1] = '\0';
-  *rtnsz = size - 1;
-  return rtn;
+  *rtnsz = out->size;
+  return out->text;
 }
 
 #ifdef BR916_STOPGAP_FIX
@@ -1267,27 +1391,111 @@ static PLI_INT32 sys_display_compiletf(ICARUS_VPI_CONST PLI_BYTE8*name)
       return sys_common_compiletf(name, 0, 0);
 }
 
+/*
+ * Everything about a $display, $write, $fdisplay, $fwrite or $sformatf
+ * call that does not change from one call to the next is gathered the
+ * first time the call runs and kept with the call handle. This
+ * includes the argument handles and a parsed plan for each constant
+ * format string.
+ */
+struct display_call_s {
+      struct strobe_cb_info info;
+      vpiHandle fd;
+      int add_newline;
+};
+
+static struct display_call_s**display_calls = 0;
+static unsigned display_calls_count = 0;
+
+/*
+ * A literal string or a string parameter keeps its value, but a
+ * string expression is passed on the thread stack. That also looks
+ * like a vpiStringConst, so use the handle itself to tell them apart.
+ */
+static int format_may_change(vpiHandle item)
+{
+#ifdef BR916_STOPGAP_FIX
+      return vpi_get(_vpiFromThr, item) != _vpiNoThr;
+#else
+      return vpi_get(vpiType, item) != vpiParameter;
+#endif
+}
+
+static struct display_call_s* get_display_call(vpiHandle callh,
+                                               const char*name)
+{
+      struct display_call_s*call = vpi_get_userdata(callh);
+      vpiHandle argv;
+      unsigned idx;
+
+      if (call) return call;
+
+      call = calloc(1, sizeof(struct display_call_s));
+      argv = vpi_iterate(vpiArgument, callh);
+      if (name[1] == 'f') {
+	    assert(argv);
+	    call->fd = vpi_scan(argv);
+      }
+
+      call->info.scope = vpi_handle(vpiScope, callh);
+      assert(call->info.scope);
+	/* We could use vpi_get_str(vpiName, callh) to get the task name,
+	 * but name is already defined. */
+      call->info.name = name;
+      call->info.filename = strdup(vpi_get_str(vpiFile, callh));
+      call->info.lineno = (int)vpi_get(vpiLineNo, callh);
+      call->info.default_format = get_default_format(name);
+      array_from_iterator(&call->info, argv);
+
+      call->info.plans = calloc(call->info.nitems ? call->info.nitems : 1,
+                                sizeof(struct format_plan*));
+      for (idx = 0 ; idx < call->info.nitems ; idx += 1) {
+	    vpiHandle item = call->info.items[idx];
+	    s_vpi_value value;
+
+	    switch (vpi_get(vpiType, item)) {
+		case vpiConstant:
+		case vpiParameter:
+		  if (vpi_get(vpiConstType, item) != vpiStringConst) break;
+		  value.format = vpiStringVal;
+		  vpi_get_value(item, &value);
+		  call->info.plans[idx] = compile_format(value.value.str);
+		  call->info.plans[idx]->recheck = format_may_change(item);
+		  break;
+		default:
+		  break;
+	    }
+      }
+
+      call->add_newline = (strncmp(name,"$display",8) == 0) ||
+                          (strncmp(name,"$fdisplay",9) == 0);
+
+      vpi_put_userdata(callh, call);
+      display_calls_count += 1;
+      display_calls = realloc(display_calls, display_calls_count*
+                                             sizeof(struct display_call_s*));
+      display_calls[display_calls_count-1] = call;
+      return call;
+}
+
 /* This implements the $sformatf, $display/$fdisplay
  * and the $write/$fwrite based tasks. */
 static PLI_INT32 sys_display_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 {
-      vpiHandle callh, argv, scope;
-      struct strobe_cb_info info;
+      vpiHandle callh;
+      struct display_call_s*call;
       char* result;
       unsigned int size;
       PLI_UINT32 fd_mcd;
       s_vpi_value val;
 
       callh = vpi_handle(vpiSysTfCall, 0);
-      argv = vpi_iterate(vpiArgument, callh);
+      call = get_display_call(callh, name);
 
 	/* Get the file/MC descriptor and verify it is valid. */
       if (name[1] == 'f') {
-	    vpiHandle fd = vpi_scan(argv);
-	    if (get_fd_mcd_from_arg(&fd_mcd, fd, callh, name)) {
-		  vpi_free_object(argv);
+	    if (get_fd_mcd_from_arg(&fd_mcd, call->fd, callh, name))
 		  return 0;
-	    }
       } else if (strncmp(name, "$sformatf", 9) == 0) {
 	      /* return as a string */
 	    fd_mcd = 0;
@@ -1296,25 +1504,13 @@ static PLI_INT32 sys_display_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 	    fd_mcd = 1;
       }
 
-      scope = vpi_handle(vpiScope, callh);
-      assert(scope);
-	/* We could use vpi_get_str(vpiName, callh) to get the task name,
-	 * but name is already defined. */
-      info.name = name;
-      info.filename = strdup(vpi_get_str(vpiFile, callh));
-      info.lineno = (int)vpi_get(vpiLineNo, callh);
-      info.default_format = get_default_format(name);
-      info.scope = scope;
-      array_from_iterator(&info, argv);
-
 	/* Because %u and %z may put embedded NULL characters into the
 	 * returned string strlen() may not match the real size! */
-      result = get_display(&size, &info);
+      result = get_display(&size, &call->info);
 
       if (fd_mcd > 0) {
-	     my_mcd_rawwrite(fd_mcd, result, size);
-	     if ((strncmp(name,"$display",8) == 0) ||
-	         (strncmp(name,"$fdisplay",9) == 0)) my_mcd_rawwrite(fd_mcd, "\n", 1);
+	     if (call->add_newline) display_append(&display_out, "\n", 1);
+	     my_mcd_rawwrite(fd_mcd, display_out.text, display_out.size);
       } else {
 	       /* Return as a string ($sformatf) */
 	     val.format = vpiStringVal;
@@ -1322,9 +1518,6 @@ static PLI_INT32 sys_display_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 	     vpi_put_value(callh, &val, 0, vpiNoDelay);
       }
 
-      free(result);
-      free(info.filename);
-      free(info.items);
       return 0;
 }
 
@@ -1350,7 +1543,6 @@ static PLI_INT32 strobe_cb(p_cb_data cb)
 	    result = get_display(&size, info);
 	    my_mcd_rawwrite(info->fd_mcd, result, size);
 	    my_mcd_rawwrite(info->fd_mcd, "\n", 1);
-	    free(result);
       }
 
       free(info->filename);
@@ -1427,7 +1619,7 @@ static PLI_INT32 sys_strobe_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
  * though that monitor may be watching many variables).
  */
 
-static struct strobe_cb_info monitor_info = { 0, 0, 0, 0, 0, 0, 0, 0 };
+static struct strobe_cb_info monitor_info = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 static vpiHandle *monitor_callbacks = 0;
 static int monitor_scheduled = 0;
 static int monitor_enabled = 1;
@@ -1445,7 +1637,6 @@ static PLI_INT32 monitor_cb_2(p_cb_data cb)
       my_mcd_rawwrite(monitor_info.fd_mcd, result, size);
       my_mcd_rawwrite(monitor_info.fd_mcd, "\n", 1);
       monitor_scheduled = 0;
-      free(result);
       return 0;
 }
 
@@ -1644,6 +1835,7 @@ static PLI_INT32 sys_swrite_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
   info.lineno = (int)vpi_get(vpiLineNo, callh);
   info.default_format = get_default_format(name);
   info.scope = scope;
+  info.plans = 0;
   array_from_iterator(&info, argv);
 
   /* Because %u and %z may put embedded NULL characters into the returned
@@ -1656,7 +1848,6 @@ static PLI_INT32 sys_swrite_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
                "(see %%u/%%z).\n", info.filename, info.lineno, name);
   }
 
-  free(val.value.str);
   free(info.filename);
   free(info.items);
   return 0;
@@ -1718,7 +1909,7 @@ static PLI_INT32 sys_sformat_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
   vpiHandle callh, argv, reg, scope;
   struct strobe_cb_info info;
   s_vpi_value val;
-  char *result, *fmt;
+  struct format_plan *plan;
   unsigned int idx, size;
 
   callh = vpi_handle(vpiSysTfCall, 0);
@@ -1726,7 +1917,7 @@ static PLI_INT32 sys_sformat_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
   reg = vpi_scan(argv);
   val.format = vpiStringVal;
   vpi_get_value(vpi_scan(argv), &val);
-  fmt = strdup(val.value.str);
+  plan = compile_format(val.value.str);
 
   scope = vpi_handle(vpiScope, callh);
   assert(scope);
@@ -1737,10 +1928,13 @@ static PLI_INT32 sys_sformat_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
   info.lineno = (int)vpi_get(vpiLineNo, callh);
   info.default_format = get_default_format(name);
   info.scope = scope;
+  info.plans = 0;
   array_from_iterator(&info, argv);
   idx = -1;
-  size = get_format(&result, fmt, &info, &idx);
-  free(fmt);
+  display_out.size = 0;
+  display_append(&display_out, "", 0);
+  size = run_format(&display_out, plan, &info, &idx);
+  free_format_plan(plan);
 
   if (idx+1< info.nitems) {
     vpi_printf("WARNING: %s:%d: %s has %d extra argument(s).\n",
@@ -1748,7 +1942,7 @@ static PLI_INT32 sys_sformat_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
                info.nitems-idx-1);
   }
 
-  val.value.str = result;
+  val.value.str = display_out.text;
   val.format = vpiStringVal;
   vpi_put_value(reg, &val, 0, vpiNoDelay);
   if (size != strlen(val.value.str)) {
@@ -1756,7 +1950,6 @@ static PLI_INT32 sys_sformat_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
                "(see %%u/%%z).\n", info.filename, info.lineno, name);
   }
 
-  free(val.value.str);
   free(info.filename);
   free(info.items);
   return 0;
@@ -2096,6 +2289,7 @@ static PLI_INT32 sys_severity_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       info.lineno = (int)vpi_get(vpiLineNo, callh);
       info.default_format = vpiDecStrVal;
       info.scope = scope;
+      info.plans = 0;
       array_from_iterator(&info, argv);
 
       vpi_printf("%s: %s:%d: ", sstr, info.filename, info.lineno);
@@ -2122,7 +2316,6 @@ static PLI_INT32 sys_severity_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       free(--sstr);  /* Get the $ back. */
       free(info.filename);
       free(info.items);
-      free(dstr);
 
       if (strncmp(name,"$fatal",6) == 0) {
 	      /* Set the exit code from vvp as an error code. */
@@ -2137,7 +2330,24 @@ static PLI_INT32 sys_severity_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 
 static PLI_INT32 sys_end_of_simulation(p_cb_data cb_data)
 {
+      unsigned idx, pdx;
+
       (void)cb_data; /* Parameter is not used. */
+      for (idx = 0 ; idx < display_calls_count ; idx += 1) {
+	    struct display_call_s*call = display_calls[idx];
+	    for (pdx = 0 ; pdx < call->info.nitems ; pdx += 1) {
+		  if (call->info.plans[pdx])
+			free_format_plan(call->info.plans[pdx]);
+	    }
+	    free(call->info.plans);
+	    free(call->info.filename);
+	    free(call->info.items);
+	    free(call);
+      }
+      free(display_calls);
+      display_calls = 0;
+      display_calls_count = 0;
+
       free(monitor_callbacks);
       monitor_callbacks = 0;
       free(monitor_info.filename);
@@ -2148,6 +2358,14 @@ static PLI_INT32 sys_end_of_simulation(p_cb_data cb_data)
 
       free(timeformat_info.suff);
       timeformat_info.suff = 0;
+
+      free(display_out.text);
+      display_out.text = 0;
+      display_out.size = 0;
+      display_out.alloc = 0;
+      free(display_scratch_text);
+      display_scratch_text = 0;
+      display_scratch_size = 0;
       return 0;
 }
 
@@ -0,0 +1,550 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include "sys_priv.h"
+
+# include  <assert.h>
+# include  <inttypes.h>
+# include  <stdlib.h>
+# include  <string.h>
+# include  "ivl_alloc.h"
+
+/*
+ * These are Icarus specific random functions built on the Philox4x32-10
+ * counter based generator (Salmon et al., "Parallel random numbers:
+ * as easy as 1, 2, 3", SC11). A counter based generator computes each
+ * block of random bits directly from a key and a block number, so any
+ * number of independent streams can be had by giving each stream its
+ * own identifier, and a stream costs no more than its block counter.
+ *
+ *   $ivl_urandom([stream])
+ *   $ivl_urandom_range(max [, min [, stream]])
+ *   $ivl_random_fill(array [, stream])
+ *   $ivl_random_seed(seed)
+ *
+ * Without a stream argument each scope (module instance, named block,
+ * task or function) has its own stream, keyed by the full name of the
+ * scope, so the values a scope sees do not depend on how many values
+ * other scopes have taken. A stream argument selects an explicit
+ * numbered stream instead, for example one per process or thread.
+ *
+ * All streams are keyed by a global 64 bit seed, which is 0 unless it
+ * is set with the -random-seed=<n> extended argument or with
+ * $ivl_random_seed. Setting the seed restarts every stream.
+ *
+ * The standard $random, $urandom and $dist_* functions are not
+ * affected by any of this.
+ */
+
+struct philox_stream_s {
+	/* 1 for a scope stream, 0 for a numbered stream. */
+      int scope_flag;
+      uint64_t id;
+      uint64_t block;
+      uint32_t buf[4];
+      unsigned avail;
+      struct philox_stream_s*next;
+};
+
+#define PHILOX_HASH_SIZE 256
+
+static struct philox_stream_s*philox_streams[PHILOX_HASH_SIZE];
+static uint64_t philox_seed = 0;
+static int philox_seed_done = 0;
+
+static void philox4x32_10(uint32_t ctr[4], const uint32_t key_in[2])
+{
+      uint32_t k0 = key_in[0], k1 = key_in[1];
+      unsigned round;
+
+      for (round = 0 ; round < 10 ; round += 1) {
+	    uint64_t p0 = (uint64_t)0xD2511F53 * ctr[0];
+	    uint64_t p1 = (uint64_t)0xCD9E8D57 * ctr[2];
+	    uint32_t c1 = ctr[1], c3 = ctr[3];
+
+	    ctr[0] = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+	    ctr[1] = (uint32_t)p1;
+	    ctr[2] = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+	    ctr[3] = (uint32_t)p0;
+
+	    k0 += 0x9E3779B9;
+	    k1 += 0xBB67AE85;
+      }
+}
+
+static uint32_t philox_next(struct philox_stream_s*str)
+{
+      if (str->avail == 0) {
+	    uint32_t key[2];
+
+	      /* The counter is the block number and the stream id. The
+	         key is the seed, flipped for scope streams so that they
+	         never collide with a numbered stream. */
+	    str->buf[0] = (uint32_t)str->block;
+	    str->buf[1] = (uint32_t)(str->block >> 32);
+	    str->buf[2] = (uint32_t)str->id;
+	    str->buf[3] = (uint32_t)(str->id >> 32);
+	    key[0] = (uint32_t)philox_seed;
+	    key[1] = (uint32_t)(philox_seed >> 32);
+	    if (str->scope_flag) key[1] = ~key[1];
+
+	    philox4x32_10(str->buf, key);
+	    str->block += 1;
+	    str->avail = 4;
+      }
+
+      str->avail -= 1;
+      return str->buf[3 - str->avail];
+}
+
+static void check_command_line_args(void)
+{
+      struct t_vpi_vlog_info vlog_info;
+      int idx;
+
+      if (philox_seed_done) return;
+      philox_seed_done = 1;
+
+      vpi_get_vlog_info(&vlog_info);
+
+      for (idx = 0 ;  idx < vlog_info.argc ;  idx += 1) {
+	    if (strncmp(vlog_info.argv[idx], "-random-seed=", 13) == 0) {
+		  philox_seed = strtoull(vlog_info.argv[idx]+13, 0, 0);
+	    }
+      }
+}
+
+static struct philox_stream_s* find_stream(int scope_flag, uint64_t id)
+{
+      unsigned bucket = (unsigned)((id ^ (id >> 29) ^ (id >> 47))
+                                   % PHILOX_HASH_SIZE);
+      struct philox_stream_s*cur;
+
+      check_command_line_args();
+
+      for (cur = philox_streams[bucket] ; cur ; cur = cur->next) {
+	    if (cur->id == id && cur->scope_flag == scope_flag)
+		  return cur;
+      }
+
+      cur = calloc(1, sizeof(struct philox_stream_s));
+      cur->scope_flag = scope_flag;
+      cur->id = id;
+      cur->next = philox_streams[bucket];
+      philox_streams[bucket] = cur;
+      return cur;
+}
+
+/*
+ * The stream of a scope is identified by a 64 bit FNV-1a hash of the
+ * full name of the scope, so it is the same from run to run no matter
+ * the order that the scopes are first used.
+ */
+static struct philox_stream_s* find_scope_stream(vpiHandle callh)
+{
+      struct philox_stream_s*str;
+      const unsigned char*cp;
+      uint64_t hash = 0xcbf29ce484222325ULL;
+
+	/* Each call remembers its stream after the first lookup. */
+      str = (struct philox_stream_s*) vpi_get_userdata(callh);
+      if (str) return str;
+
+      cp = (const unsigned char*)
+	    vpi_get_str(vpiFullName, vpi_handle(vpiScope, callh));
+      for ( ; *cp ; cp += 1) {
+	    hash ^= *cp;
+	    hash *= 0x100000001b3ULL;
+      }
+
+      str = find_stream(1, hash);
+      vpi_put_userdata(callh, str);
+      return str;
+}
+
+static uint64_t get_u64_value(vpiHandle arg)
+{
+      s_vpi_value val;
+      uint64_t res;
+      int size = vpi_get(vpiSize, arg);
+
+      val.format = vpiVectorVal;
+      vpi_get_value(arg, &val);
+      res = (uint32_t)val.value.vector[0].aval;
+      if (size > 32)
+	    res |= (uint64_t)(uint32_t)val.value.vector[1].aval << 32;
+      return res;
+}
+
+/*
+ * Get the stream from the optional stream argument, or the scope
+ * stream of the call if there is none.
+ */
+static struct philox_stream_s* get_stream(vpiHandle callh, vpiHandle arg)
+{
+      if (arg) return find_stream(0, get_u64_value(arg));
+      return find_scope_stream(callh);
+}
+
+static PLI_INT32 ivl_urandom_compiletf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle arg;
+
+	/* The stream is optional. */
+      if (argv == 0) return 0;
+
+      arg = vpi_scan(argv);
+      if (! is_numeric_obj(arg)) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s's stream argument must be numeric.\n", name);
+	    vpi_control(vpiFinish, 1);
+      }
+
+      check_for_extra_args(argv, callh, name, "one argument", 1);
+
+      return 0;
+}
+
+static PLI_INT32 ivl_urandom_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle arg = 0;
+      s_vpi_value val;
+
+      (void)name; /* Parameter is not used. */
+
+      if (argv) {
+	    arg = vpi_scan(argv);
+	    vpi_free_object(argv);
+      }
+
+      val.format = vpiIntVal;
+      val.value.integer = (PLI_INT32) philox_next(get_stream(callh, arg));
+      vpi_put_value(callh, &val, 0, vpiNoDelay);
+
+      return 0;
+}
+
+static PLI_INT32 ivl_urandom_range_compiletf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle arg;
+      unsigned count = 0;
+
+      if (argv == 0) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s requires one to three arguments.\n", name);
+	    vpi_control(vpiFinish, 1);
+	    return 0;
+      }
+
+      while (count < 3 && (arg = vpi_scan(argv))) {
+	    count += 1;
+	    if (! is_numeric_obj(arg)) {
+		  vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+		             (int)vpi_get(vpiLineNo, callh));
+		  vpi_printf("%s's arguments must be numeric.\n", name);
+		  vpi_control(vpiFinish, 1);
+	    }
+      }
+
+      if (count == 3)
+	    check_for_extra_args(argv, callh, name, "three arguments", 1);
+
+      return 0;
+}
+
+static PLI_INT32 ivl_urandom_range_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle maxval, minval, stream = 0;
+      s_vpi_value val;
+      uint32_t i_maxval, i_minval = 0;
+      uint64_t range;
+
+      (void)name; /* Parameter is not used. */
+
+      maxval = vpi_scan(argv);
+      minval = vpi_scan(argv);
+      if (minval) stream = vpi_scan(argv);
+      if (stream) vpi_free_object(argv);
+
+      val.format = vpiIntVal;
+      vpi_get_value(maxval, &val);
+      i_maxval = val.value.integer;
+      if (minval) {
+	    vpi_get_value(minval, &val);
+	    i_minval = val.value.integer;
+      }
+
+	/* Swap the two arguments if they are out of order. */
+      if (i_minval > i_maxval) {
+	    uint32_t tmp = i_minval;
+	    i_minval = i_maxval;
+	    i_maxval = tmp;
+      }
+
+	/* Scale a 32 bit value into the range with a multiply and
+	   shift instead of a divide. */
+      range = (uint64_t)(i_maxval - i_minval) + 1;
+      val.value.integer = (PLI_INT32) (i_minval +
+	    (uint32_t)((philox_next(get_stream(callh, stream)) * range) >> 32));
+      vpi_put_value(callh, &val, 0, vpiNoDelay);
+
+      return 0;
+}
+
+static PLI_INT32 ivl_random_fill_compiletf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle arg;
+
+      if (argv == 0) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s requires an array argument.\n", name);
+	    vpi_control(vpiFinish, 1);
+	    return 0;
+      }
+
+	/* The first argument must be an unpacked or dynamic array. */
+      arg = vpi_scan(argv);
+      switch (vpi_get(vpiType, arg)) {
+	  case vpiMemory:
+	    break;
+	  case vpiArrayVar:
+	    if (vpi_get(vpiArrayType, arg) == vpiDynamicArray)
+		  break;
+	      /* fallthrough */
+	  default:
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s's first argument must be an unpacked or "
+	               "dynamic array.\n", name);
+	    vpi_control(vpiFinish, 1);
+	    vpi_free_object(argv);
+	    return 0;
+      }
+
+	/* The stream is optional. */
+      arg = vpi_scan(argv);
+      if (arg == 0) return 0;
+
+      if (! is_numeric_obj(arg)) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s's stream argument must be numeric.\n", name);
+	    vpi_control(vpiFinish, 1);
+      }
+
+      check_for_extra_args(argv, callh, name, "two arguments", 1);
+
+      return 0;
+}
+
+/*
+ * Fill every word of the array with random values. Real words get a
+ * uniform value in [0,1), vector words get random bits across their
+ * full width. The values are taken from the stream in word order.
+ */
+static PLI_INT32 ivl_random_fill_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle array, stream, iter, word;
+      struct philox_stream_s*str;
+      s_vpi_vecval*vec = 0;
+      unsigned nwords = 0;
+      int real_flag = -1;
+
+      (void)name; /* Parameter is not used. */
+
+      array = vpi_scan(argv);
+      stream = vpi_scan(argv);
+      if (stream) vpi_free_object(argv);
+
+      str = get_stream(callh, stream);
+
+      iter = vpi_iterate(vpiMemoryWord, array);
+      if (iter == 0) return 0;
+
+      while ( (word = vpi_scan(iter)) ) {
+	    s_vpi_value val;
+
+	      /* All the words of an array have the same type and
+	         width, so look at the first to see what to make. */
+	    if (real_flag < 0) {
+		  val.format = vpiObjTypeVal;
+		  vpi_get_value(word, &val);
+		  real_flag = val.format == vpiRealVal;
+		  if (! real_flag) {
+			nwords = (vpi_get(vpiSize, word) + 31) / 32;
+			vec = calloc(nwords, sizeof(s_vpi_vecval));
+		  }
+	    }
+
+	    if (real_flag) {
+		  uint64_t bits = philox_next(str);
+		  bits = (bits << 21) ^ (philox_next(str) >> 11);
+		  val.format = vpiRealVal;
+		  val.value.real = (double)bits * (1.0 / 9007199254740992.0);
+	    } else {
+		  unsigned idx;
+		  for (idx = 0 ; idx < nwords ; idx += 1) {
+			vec[idx].aval = (PLI_INT32) philox_next(str);
+			vec[idx].bval = 0;
+		  }
+		  val.format = vpiVectorVal;
+		  val.value.vector = vec;
+	    }
+
+	    vpi_put_value(word, &val, 0, vpiNoDelay);
+      }
+
+      free(vec);
+      return 0;
+}
+
+static PLI_INT32 ivl_random_seed_compiletf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+
+      if (argv == 0) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s requires a seed argument.\n", name);
+	    vpi_control(vpiFinish, 1);
+	    return 0;
+      }
+
+      if (! is_numeric_obj(vpi_scan(argv))) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s's seed argument must be numeric.\n", name);
+	    vpi_control(vpiFinish, 1);
+      }
+
+      check_for_extra_args(argv, callh, name, "one argument", 0);
+
+      return 0;
+}
+
+static PLI_INT32 ivl_random_seed_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle seed = vpi_scan(argv);
+      unsigned idx;
+
+      (void)name; /* Parameter is not used. */
+
+      vpi_free_object(argv);
+
+	/* An explicit seed overrides the command line. */
+      philox_seed_done = 1;
+      philox_seed = get_u64_value(seed);
+
+	/* Restart all the streams from the new seed. */
+      for (idx = 0 ; idx < PHILOX_HASH_SIZE ; idx += 1) {
+	    struct philox_stream_s*cur;
+	    for (cur = philox_streams[idx] ; cur ; cur = cur->next) {
+		  cur->block = 0;
+		  cur->avail = 0;
+	    }
+      }
+
+      return 0;
+}
+
+static PLI_INT32 sys_end_of_simulation(p_cb_data cb_data)
+{
+      unsigned idx;
+
+      (void)cb_data; /* Parameter is not used. */
+
+      for (idx = 0 ; idx < PHILOX_HASH_SIZE ; idx += 1) {
+	    while (philox_streams[idx]) {
+		  struct philox_stream_s*cur = philox_streams[idx];
+		  philox_streams[idx] = cur->next;
+		  free(cur);
+	    }
+      }
+
+      return 0;
+}
+
+void sys_random_philox_register(void)
+{
+      s_vpi_systf_data tf_data;
+      s_cb_data cb_data;
+      vpiHandle res;
+
+      tf_data.type        = vpiSysFunc;
+      tf_data.sysfunctype = vpiSysFuncInt;
+      tf_data.tfname      = "$ivl_urandom";
+      tf_data.calltf      = ivl_urandom_calltf;
+      tf_data.compiletf   = ivl_urandom_compiletf;
+      tf_data.sizetf      = 0;
+      tf_data.user_data   = "$ivl_urandom";
+      res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+
+      tf_data.type        = vpiSysFunc;
+      tf_data.sysfunctype = vpiSysFuncInt;
+      tf_data.tfname      = "$ivl_urandom_range";
+      tf_data.calltf      = ivl_urandom_range_calltf;
+      tf_data.compiletf   = ivl_urandom_range_compiletf;
+      tf_data.sizetf      = 0;
+      tf_data.user_data   = "$ivl_urandom_range";
+      res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+
+      tf_data.type        = vpiSysTask;
+      tf_data.tfname      = "$ivl_random_fill";
+      tf_data.calltf      = ivl_random_fill_calltf;
+      tf_data.compiletf   = ivl_random_fill_compiletf;
+      tf_data.sizetf      = 0;
+      tf_data.user_data   = "$ivl_random_fill";
+      res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+
+      tf_data.type        = vpiSysTask;
+      tf_data.tfname      = "$ivl_random_seed";
+      tf_data.calltf      = ivl_random_seed_calltf;
+      tf_data.compiletf   = ivl_random_seed_compiletf;
+      tf_data.sizetf      = 0;
+      tf_data.user_data   = "$ivl_random_seed";
+      res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+
+      cb_data.reason = cbEndOfSimulation;
+      cb_data.time = 0;
+      cb_data.cb_rtn = sys_end_of_simulation;
+      cb_data.user_data = "system";
+      vpi_register_cb(&cb_data);
+}
@@ -21,6 +21,7 @@
 # include  "sdf_priv.h"
 # include  <stdlib.h>
 # include  <string.h>
+# include  <sys/time.h>
 # include  <assert.h>
 
 /*
@@ -37,25 +38,254 @@ static vpiHandle sdf_callh = 0;
   /* The cell in process. */
 static vpiHandle sdf_cur_cell;
 
-static vpiHandle find_scope(vpiHandle scope, const char*name)
+  /* The SDF file being read, and the progress through it. */
+static FILE*sdf_fd = 0;
+static unsigned long sdf_cell_count;
+static unsigned long sdf_iopath_count;
+
+  /* Report progress (when informing) every this many cells. */
+#define SDF_PROGRESS_CELLS 100000
+
+/*
+ * A large SDF file selects a great many cell instances, and each cell
+ * may have many IOPATH entries. Scanning the children of a scope for
+ * every instance, and the modpaths of a cell for every IOPATH, makes
+ * annotation quadratic. Instead the children of a scope and the
+ * modpaths of a cell are entered into a hash table the first time
+ * the scope or cell is looked at. An item is keyed by the scope (or
+ * cell) that owns it and one (child name) or two (modpath source and
+ * destination) names. The tables are released after each
+ * $sdf_annotate call.
+ */
+struct sdf_index_item_s {
+      vpiHandle owner;
+      char*name;
+      char*dst;
+      vpiHandle item;
+      int edge;
+      unsigned long hash;
+      struct sdf_index_item_s*next;
+};
+
+struct sdf_index_s {
+      unsigned long size;
+      unsigned long count;
+      struct sdf_index_item_s**table;
+};
+
+  /* Child scopes, keyed by parent scope and child name. */
+static struct sdf_index_s sdf_child_index = { 0, 0, 0 };
+  /* Modpaths, keyed by cell and source/destination port names. */
+static struct sdf_index_s sdf_path_index = { 0, 0, 0 };
+  /* The scopes and cells that have been entered into the above. */
+static struct sdf_index_s sdf_indexed = { 0, 0, 0 };
+
+static unsigned long sdf_hash(vpiHandle owner, const char*name,
+                              const char*dst)
 {
-      vpiHandle idx = vpi_iterate(vpiModule, scope);
-	/* If this scope has no modules then it can't have the one we
-	 * are looking for so just return 0. */
-      if (idx == 0) return 0;
+      unsigned long hash = (unsigned long)(size_t)owner;
+      const unsigned char*cp;
+
+      hash ^= hash >> 7;
+      for (cp = (const unsigned char*)name ; *cp ; cp += 1)
+	    hash = (hash * 33) ^ *cp;
+      if (dst) {
+	    hash = (hash * 33) ^ ' ';
+	    for (cp = (const unsigned char*)dst ; *cp ; cp += 1)
+		  hash = (hash * 33) ^ *cp;
+      }
 
-      vpiHandle cur;
-      while ( (cur = vpi_scan(idx)) ) {
+      return hash;
+}
 
-	    if ( strcmp(name, vpi_get_str(vpiName,cur)) == 0) {
-		  vpi_free_object(idx);
-		  return cur;
+static int sdf_index_match(const struct sdf_index_item_s*cur,
+                           unsigned long hash, vpiHandle owner,
+                           const char*name, const char*dst)
+{
+      if (cur->hash != hash || cur->owner != owner)
+	    return 0;
+      if (strcmp(cur->name, name) != 0)
+	    return 0;
+      if (dst == 0)
+	    return cur->dst == 0;
+      return cur->dst && strcmp(cur->dst, dst) == 0;
+}
+
+static void sdf_index_add(struct sdf_index_s*idx, vpiHandle owner,
+                          const char*name, const char*dst,
+                          vpiHandle item, int edge)
+{
+      struct sdf_index_item_s*cur;
+      unsigned long bucket;
+
+	/* Keep the table no more than one item per bucket on average. */
+      if (idx->count >= idx->size) {
+	    unsigned long new_size = idx->size ? 2*idx->size : 1024;
+	    struct sdf_index_item_s**new_table
+		  = calloc(new_size, sizeof(struct sdf_index_item_s*));
+	    unsigned long tmp;
+	    for (tmp = 0 ; tmp < idx->size ; tmp += 1) {
+		  while ( (cur = idx->table[tmp]) ) {
+			idx->table[tmp] = cur->next;
+			bucket = cur->hash % new_size;
+			cur->next = new_table[bucket];
+			new_table[bucket] = cur;
+		  }
 	    }
+	    free(idx->table);
+	    idx->table = new_table;
+	    idx->size = new_size;
+      }
+
+      cur = malloc(sizeof(struct sdf_index_item_s));
+      cur->owner = owner;
+      cur->name = strdup(name);
+      cur->dst = dst ? strdup(dst) : 0;
+      cur->item = item;
+      cur->edge = edge;
+      cur->hash = sdf_hash(owner, name, dst);
+
+      bucket = cur->hash % idx->size;
+      cur->next = idx->table[bucket];
+      idx->table[bucket] = cur;
+      idx->count += 1;
+}
+
+/*
+ * Return the first item that matches the key, or 0. Pass the
+ * previous match as "prev" to continue the search with the next
+ * matching item.
+ */
+static struct sdf_index_item_s* sdf_index_find(struct sdf_index_s*idx,
+                                               struct sdf_index_item_s*prev,
+                                               vpiHandle owner,
+                                               const char*name,
+                                               const char*dst)
+{
+      struct sdf_index_item_s*cur;
+      unsigned long hash = sdf_hash(owner, name, dst);
+
+      if (idx->size == 0)
+	    return 0;
+
+      cur = prev ? prev->next : idx->table[hash % idx->size];
+      for ( ; cur ; cur = cur->next) {
+	    if (sdf_index_match(cur, hash, owner, name, dst))
+		  return cur;
       }
 
       return 0;
 }
 
+static void sdf_index_clear(struct sdf_index_s*idx)
+{
+      unsigned long tmp;
+      for (tmp = 0 ; tmp < idx->size ; tmp += 1) {
+	    struct sdf_index_item_s*cur;
+	    while ( (cur = idx->table[tmp]) ) {
+		  idx->table[tmp] = cur->next;
+		  free(cur->name);
+		  free(cur->dst);
+		  free(cur);
+	    }
+      }
+      free(idx->table);
+      idx->table = 0;
+      idx->size = 0;
+      idx->count = 0;
+}
+
+/*
+ * Enter all the child scopes of the given scope into the child
+ * index. If a name appears more than once, the first one wins, as it
+ * would in a linear search.
+ */
+static void index_child_scopes(vpiHandle scope)
+{
+      vpiHandle idx, cur;
+
+      sdf_index_add(&sdf_indexed, scope, "module", 0, scope, 0);
+
+      idx = vpi_iterate(vpiModule, scope);
+      if (idx == 0) return;
+
+      while ( (cur = vpi_scan(idx)) ) {
+	    const char*name = vpi_get_str(vpiName, cur);
+	    if (sdf_index_find(&sdf_child_index, 0, scope, name, 0))
+		  continue;
+	    sdf_index_add(&sdf_child_index, scope, name, 0, cur, 0);
+      }
+}
+
+static vpiHandle find_scope(vpiHandle scope, const char*name)
+{
+      struct sdf_index_item_s*cur;
+
+      if (! sdf_index_find(&sdf_indexed, 0, scope, "module", 0))
+	    index_child_scopes(scope);
+
+      cur = sdf_index_find(&sdf_child_index, 0, scope, name, 0);
+      return cur ? cur->item : 0;
+}
+
+/*
+ * Enter all the modpaths of the cell into the path index, keyed by
+ * the names of the source and destination ports.
+ */
+static void index_cell_modpaths(vpiHandle cell)
+{
+      vpiHandle iter, path;
+
+      sdf_index_add(&sdf_indexed, cell, "modpath", 0, cell, 0);
+
+      iter = vpi_iterate(vpiModPath, cell);
+      if (iter == 0) return;
+
+      while ( (path = vpi_scan(iter)) ) {
+	    char*src;
+	    vpiHandle path_t_in = vpi_handle(vpiModPathIn,path);
+	    vpiHandle path_t_out = vpi_handle(vpiModPathOut,path);
+
+	    vpiHandle path_in = vpi_handle(vpiExpr,path_t_in);
+	    vpiHandle path_out = vpi_handle(vpiExpr,path_t_out);
+
+	      /* The expressions for the path terms must be signals,
+	         vpiNet or vpiReg. */
+	    assert(vpi_get(vpiType,path_in) == vpiNet);
+	    assert(vpi_get(vpiType,path_out) == vpiNet
+		   || vpi_get(vpiType,path_out) == vpiReg);
+
+	      /* The string returned by vpi_get_str() is only good
+	         until the next call, so keep a copy of the source. */
+	    src = strdup(vpi_get_str(vpiName,path_in));
+	    sdf_index_add(&sdf_path_index, cell, src,
+	                  vpi_get_str(vpiName,path_out), path,
+	                  vpi_get(vpiEdge,path_t_in));
+	    free(src);
+      }
+}
+
+  /* The wall clock time in seconds, for the throughput report. */
+static double wall_seconds(void)
+{
+      struct timeval tv;
+      gettimeofday(&tv, 0);
+      return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void report_progress(const char*what)
+{
+      long pos = sdf_fd ? ftell(sdf_fd) : -1;
+
+      vpi_printf("SDF INFO: %s:%d: ", vpi_get_str(vpiFile, sdf_callh),
+                 (int)vpi_get(vpiLineNo, sdf_callh));
+      vpi_printf("%s %lu cells, %lu IOPATHs", what, sdf_cell_count,
+                 sdf_iopath_count);
+      if (pos >= 0)
+	    vpi_printf(", %ld bytes read", pos);
+      vpi_printf(".\n");
+}
+
 /*
  * These functions are called by the SDF parser during parsing to
  * handling items discovered in the parse.
@@ -65,6 +295,10 @@ void sdf_select_instance(const char*celltype, const char*cellinst)
 {
       char buffer[128];
 
+      sdf_cell_count += 1;
+      if (sdf_flag_inform && sdf_cell_count % SDF_PROGRESS_CELLS == 0)
+	    report_progress("Progress:");
+
 	/* First follow the hierarchical parts of the cellinst name to
 	   get to the cell that I'm looking for. */
       vpiHandle scope = sdf_scope;
@@ -138,46 +372,33 @@ static const char*edge_str(int vpi_edge)
 void sdf_iopath_delays(int vpi_edge, const char*src, const char*dst,
 		       const struct sdf_delval_list_s*delval_list)
 {
-      vpiHandle iter, path;
+      struct sdf_index_item_s*cur;
       int match_count = 0;
 
       if (sdf_cur_cell == 0)
 	    return;
 
-      iter = vpi_iterate(vpiModPath, sdf_cur_cell);
+      sdf_iopath_count += 1;
+
+      if (! sdf_index_find(&sdf_indexed, 0, sdf_cur_cell, "modpath", 0))
+	    index_cell_modpaths(sdf_cur_cell);
 
 	/* Search for the modpath that matches the IOPATH by looking
 	   for the modpath that uses the same ports as the ports that
 	   the parser has found. */
-      if (iter) while ( (path = vpi_scan(iter)) ) {
+      cur = 0;
+      while ( (cur = sdf_index_find(&sdf_path_index, cur, sdf_cur_cell,
+                                    src, dst)) ) {
 	    s_vpi_delay delays;
 	    struct t_vpi_time delay_vals[12];
+	    vpiHandle path = cur->item;
 	    int idx;
 
-	    vpiHandle path_t_in = vpi_handle(vpiModPathIn,path);
-	    vpiHandle path_t_out = vpi_handle(vpiModPathOut,path);
-
-	    vpiHandle path_in = vpi_handle(vpiExpr,path_t_in);
-	    vpiHandle path_out = vpi_handle(vpiExpr,path_t_out);
-
-	      /* The expressions for the path terms must be signals,
-	         vpiNet or vpiReg. */
-	    assert(vpi_get(vpiType,path_in) == vpiNet);
-	    assert(vpi_get(vpiType,path_out) == vpiNet
-		   || vpi_get(vpiType,path_out) == vpiReg);
-
-	      /* If the src name doesn't match, go on. */
-	    if (strcmp(src,vpi_get_str(vpiName,path_in)) != 0)
-		  continue;
 	      /* The edge type must match too. But note that if this
 	         IOPATH has no edge, then it matches with all edges of
 	         the modpath object. */
 /* --> Is this correct in the context of the 10, 01, etc. edges? */
-	    if (vpi_edge != vpiNoEdge && vpi_get(vpiEdge,path_t_in) != vpi_edge)
-		  continue;
-
-	      /* If the dst name doesn't match, go on. */
-	    if (strcmp(dst,vpi_get_str(vpiName,path_out)) != 0)
+	    if (vpi_edge != vpiNoEdge && cur->edge != vpi_edge)
 		  continue;
 
 	      /* Ah, this must be a match! */
@@ -286,7 +507,7 @@ static PLI_INT32 sys_sdf_annotate_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
       vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
       vpiHandle argv = vpi_iterate(vpiArgument, callh);
-      FILE *sdf_fd;
+      double start;
       char *fname = get_filename(callh, name, vpi_scan(argv));
 
       if (fname == 0) {
@@ -315,10 +536,30 @@ static PLI_INT32 sys_sdf_annotate_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 
       sdf_cur_cell = 0;
       sdf_callh = callh;
+      sdf_cell_count = 0;
+      sdf_iopath_count = 0;
+      start = wall_seconds();
       sdf_process_file(sdf_fd, fname);
+
+      if (sdf_flag_inform) {
+	    double secs = wall_seconds() - start;
+	    long size = ftell(sdf_fd);
+	    report_progress("Annotated");
+	    vpi_printf("SDF INFO: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("Read \"%s\" in %.2f seconds", fname, secs);
+	    if (secs > 0.0 && size > 0)
+		  vpi_printf(" (%.1f MB/s)", size / secs / (1024.0*1024.0));
+	    vpi_printf(".\n");
+      }
       sdf_callh = 0;
 
+      sdf_index_clear(&sdf_child_index);
+      sdf_index_clear(&sdf_path_index);
+      sdf_index_clear(&sdf_indexed);
+
       fclose(sdf_fd);
+      sdf_fd = 0;
       free(fname);
       return 0;
 }
@@ -34,6 +34,7 @@ extern void sys_plusargs_register(void);
 extern void sys_queue_register(void);
 extern void sys_random_register(void);
 extern void sys_random_mti_register(void);
+extern void sys_random_philox_register(void);
 extern void sys_readmem_register(void);
 extern void sys_scanf_register(void);
 extern void sys_sdf_register(void);
@@ -207,6 +208,7 @@ void (*vlog_startup_routines[])(void) = {
       sys_queue_register,
       sys_random_register,
       sys_random_mti_register,
+      sys_random_philox_register,
       sys_readmem_register,
       sys_scanf_register,
       sys_time_register,
@@ -21,6 +21,7 @@
 # include  "compile.h"
 # include  "vpi_priv.h"
 # include  "config.h"
+# include  "statistics.h"
 # include  <map>
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
@@ -29,6 +30,9 @@
 
 using namespace std;
 
+unsigned long count_cobject_new = 0;
+unsigned long count_cobject_blocks = 0;
+
 /*
  * This class_property_t class is an abstract base class for
  * representing a property of an instance. The definition keeps and
@@ -396,14 +400,37 @@ void property_object::copy(char*dst, char*src)
 
 /* **** */
 
+/*
+ * An object block is a header word followed by the object (head_size_
+ * bytes) and then the instance properties. The header word holds the
+ * owning class_type while the block is in use, and links the block
+ * into the free list of the class while it is not. POOL_ALIGN keeps
+ * the object and the properties suitably aligned.
+ */
+static const size_t POOL_ALIGN = 16;
+
+static inline size_t pool_round(size_t size)
+{
+      return (size + POOL_ALIGN - 1) & ~(POOL_ALIGN - 1);
+}
+
 class_type::class_type(const string&nam, size_t nprop)
 : class_name_(nam), properties_(nprop)
 {
       instance_size_ = 0;
+      pool_ = 0;
+      head_size_ = 0;
+      block_size_ = 0;
 }
 
 class_type::~class_type()
 {
+      while (pool_) {
+	    char*block = reinterpret_cast<char*> (pool_);
+	    pool_ = *reinterpret_cast<void**> (block);
+	    delete[]block;
+      }
+
       for (size_t idx = 0 ; idx < properties_.size() ; idx += 1)
 	    delete properties_[idx].type;
 }
@@ -480,9 +507,42 @@ void class_type::finish_setup(void)
       }
 }
 
-class_type::inst_t class_type::instance_new() const
+void* class_type::object_alloc(size_t head) const
 {
-      char*buf = new char [instance_size_];
+      if (block_size_ == 0) {
+	    head_size_ = pool_round(head);
+	    block_size_ = POOL_ALIGN + head_size_ + pool_round(instance_size_);
+      }
+      assert(pool_round(head) == head_size_);
+
+      count_cobject_new += 1;
+
+      char*block;
+      if (pool_) {
+	    block = reinterpret_cast<char*> (pool_);
+	    pool_ = *reinterpret_cast<void**> (block);
+      } else {
+	    block = new char [block_size_];
+	    count_cobject_blocks += 1;
+      }
+
+      *reinterpret_cast<const class_type**> (block) = this;
+      return block + POOL_ALIGN;
+}
+
+void class_type::object_free(void*obj)
+{
+      char*block = reinterpret_cast<char*> (obj) - POOL_ALIGN;
+      const class_type*defn = *reinterpret_cast<const class_type**> (block);
+
+      *reinterpret_cast<void**> (block) = defn->pool_;
+      defn->pool_ = block;
+}
+
+class_type::inst_t class_type::instance_new(void*obj) const
+{
+      assert(head_size_ != 0);
+      char*buf = reinterpret_cast<char*> (obj) + head_size_;
 
       for (size_t idx = 0 ; idx < properties_.size() ; idx += 1)
 	    properties_[idx].type->construct(buf);
@@ -496,8 +556,6 @@ void class_type::instance_delete(class_type::inst_t obj) const
 
       for (size_t idx = 0 ; idx < properties_.size() ; idx += 1)
 	    properties_[idx].type->destruct(buf);
-
-      delete[]buf;
 }
 
 void class_type::set_vec4(class_type::inst_t obj, size_t pid,
@@ -56,10 +56,20 @@ class class_type : public __vpiHandle {
       void finish_setup(void);
 
     public:
-	// Constructors and destructors for making instances.
-      inst_t instance_new() const;
+	// Constructors and destructors for making instances. The
+	// property storage is laid out in the same block as the
+	// object that holds it, right after the object. The obj
+	// argument is an object allocated by object_alloc.
+      inst_t instance_new(void*obj) const;
       void instance_delete(inst_t) const;
 
+	// Allocate and release a block for an object of head bytes
+	// followed by the property storage of an instance. Released
+	// blocks are kept on a per-class free list and reused for
+	// the next object of the class.
+      void*object_alloc(size_t head) const;
+      static void object_free(void*obj);
+
       void set_vec4(inst_t inst, size_t pid, const vvp_vector4_t&val) const;
       void get_vec4(inst_t inst, size_t pid, vvp_vector4_t&val) const;
       void set_real(inst_t inst, size_t pid, double val) const;
@@ -83,6 +93,12 @@ class class_type : public __vpiHandle {
       };
       std::vector<prop_t> properties_;
       size_t instance_size_;
+
+	// The object block free list. The head size is fixed by the
+	// first object_alloc, and the block size follows from it.
+      mutable void*pool_;
+      mutable size_t head_size_;
+      mutable size_t block_size_;
 };
 
 #endif /* IVL_class_type_H */
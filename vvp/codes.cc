@@ -25,6 +25,7 @@
 #endif
 # include  <cstring>
 # include  <cassert>
+# include  <map>
 
 /*
  * The code space is broken into chunks, to make for efficient
@@ -96,6 +97,46 @@ vvp_code_t codespace_null(void)
       return first_chunk + 0;
 }
 
+/*
+ * The chunks are not in address order, so to find the chunk of an
+ * address, index the chunks by their start address. Also note for
+ * each chunk the last %file_line in the chunks before it, so that
+ * only the chunk of the address needs to be searched.
+ */
+vvp_code_t codespace_file_line(vvp_code_t pc)
+{
+      static std::map<vvp_code_t,vvp_code_t> chunks;
+
+      if (chunks.empty()) {
+	    vvp_code_t last = 0;
+	    for (vvp_code_t cur = first_chunk ; cur ; cur = cur[code_chunk_size-1].cptr) {
+		  chunks[cur] = last;
+		  unsigned count = cur == current_chunk? current_within_chunk : code_chunk_size-1;
+		  for (unsigned idx = 0 ; idx < count ; idx += 1) {
+			if (cur[idx].opcode == &of_FILE_LINE)
+			      last = cur + idx;
+		  }
+	    }
+      }
+
+      std::map<vvp_code_t,vvp_code_t>::iterator cur = chunks.upper_bound(pc);
+      if (cur == chunks.begin())
+	    return 0;
+      --cur;
+
+      vvp_code_t chunk = cur->first;
+      if (pc >= chunk + code_chunk_size)
+	    return 0;
+
+      for (vvp_code_t scan = pc ; scan > chunk ; ) {
+	    scan -= 1;
+	    if (scan->opcode == &of_FILE_LINE)
+		  return scan;
+      }
+
+      return cur->second;
+}
+
 #ifdef CHECK_WITH_VALGRIND
 void codespace_delete(void)
 {
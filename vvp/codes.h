@@ -265,6 +265,12 @@ extern bool of_REAP_UFUNC(vthread_t thr, vvp_code_t code);
 
 extern bool of_CHUNK_LINK(vthread_t thr, vvp_code_t code);
 
+/*
+ * Return the mnemonic for the opcode function, for reports. The
+ * opcode table is in compile.cc.
+ */
+extern const char*opcode_mnemonic(vvp_code_fun fun);
+
 /*
  * This is the format of a machine code instruction.
  */
@@ -307,4 +313,11 @@ extern vvp_code_t codespace_allocate(void);
 extern vvp_code_t codespace_next(void);
 extern vvp_code_t codespace_null(void);
 
+/*
+ * Return the last %file_line instruction before the address in the
+ * code space, or nil if there is none. The profiler uses this to map
+ * a thread's program counter to its source line.
+ */
+extern vvp_code_t codespace_file_line(vvp_code_t pc);
+
 #endif /* IVL_codes_H */
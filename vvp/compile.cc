@@ -318,6 +318,30 @@ static int opcode_compare(const void*k, const void*r)
       return strcmp(kp, rp->mnemonic);
 }
 
+const char*opcode_mnemonic(vvp_code_fun fun)
+{
+      for (unsigned idx = 0 ; idx < opcode_count ; idx += 1) {
+	    if (opcode_table[idx].opcode == fun)
+		  return opcode_table[idx].mnemonic;
+      }
+
+	/* These are generated by the compiler, not from the table. */
+      if (fun == &of_FILE_LINE)
+	    return "%file_line";
+      if (fun == &of_CHUNK_LINK)
+	    return "(chunk_link)";
+      if (fun == &of_ZOMBIE)
+	    return "(zombie)";
+      if (fun == &of_EXEC_UFUNC_REAL)
+	    return "(exec_ufunc/real)";
+      if (fun == &of_EXEC_UFUNC_VEC4)
+	    return "(exec_ufunc/vec4)";
+      if (fun == &of_REAP_UFUNC)
+	    return "(reap_ufunc)";
+
+      return "(unknown)";
+}
+
 /*
  * Keep a symbol table of addresses within code space. Labels on
  * executable opcodes are mapped to their address here.
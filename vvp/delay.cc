@@ -19,6 +19,7 @@
 
 #include "delay.h"
 #include "schedule.h"
+#include "slab.h"
 #include "vpi_priv.h"
 #include "config.h"
 #ifdef CHECK_WITH_VALGRIND
@@ -148,6 +149,57 @@ void vvp_delay_t::set_decay(vvp_time64_t val)
 	    calculate_min_delay_();
 }
 
+static const size_t DELAY4_CHUNK_COUNT = 8192 / sizeof(vvp_fun_delay::event_vec4_);
+static slab_t<sizeof(vvp_fun_delay::event_vec4_),DELAY4_CHUNK_COUNT> delay4_heap;
+
+static const size_t DELAY8_CHUNK_COUNT = 8192 / sizeof(vvp_fun_delay::event_vec8_);
+static slab_t<sizeof(vvp_fun_delay::event_vec8_),DELAY8_CHUNK_COUNT> delay8_heap;
+
+static const size_t DELAYR_CHUNK_COUNT = 8192 / sizeof(vvp_fun_delay::event_real_);
+static slab_t<sizeof(vvp_fun_delay::event_real_),DELAYR_CHUNK_COUNT> delayr_heap;
+
+void* vvp_fun_delay::event_vec4_::operator new(size_t size)
+{
+      assert(size == sizeof(event_vec4_));
+      return delay4_heap.alloc_slab();
+}
+
+void vvp_fun_delay::event_vec4_::operator delete(void*dptr)
+{
+      delay4_heap.free_slab(dptr);
+}
+
+void* vvp_fun_delay::event_vec8_::operator new(size_t size)
+{
+      assert(size == sizeof(event_vec8_));
+      return delay8_heap.alloc_slab();
+}
+
+void vvp_fun_delay::event_vec8_::operator delete(void*dptr)
+{
+      delay8_heap.free_slab(dptr);
+}
+
+void* vvp_fun_delay::event_real_::operator new(size_t size)
+{
+      assert(size == sizeof(event_real_));
+      return delayr_heap.alloc_slab();
+}
+
+void vvp_fun_delay::event_real_::operator delete(void*dptr)
+{
+      delayr_heap.free_slab(dptr);
+}
+
+#ifdef CHECK_WITH_VALGRIND
+void delay_pool_delete(void)
+{
+      delay4_heap.delete_pool();
+      delay8_heap.delete_pool();
+      delayr_heap.delete_pool();
+}
+#endif
+
 vvp_fun_delay::vvp_fun_delay(vvp_net_t*n, unsigned width, const vvp_delay_t&d)
 : net_(n), delay_(d)
 {
@@ -160,6 +212,7 @@ vvp_fun_delay::vvp_fun_delay(vvp_net_t*n, unsigned width, const vvp_delay_t&d)
             schedule_init_propagate(net_, cur_real_);
       }
       list_ = 0;
+      spare_ = 0;
       type_ = UNKNOWN_DELAY;
       initial_ = true;
 	// Calculate the values used when converting variable delays
@@ -178,66 +231,176 @@ vvp_fun_delay::vvp_fun_delay(vvp_net_t*n, unsigned width, const vvp_delay_t&d)
 vvp_fun_delay::~vvp_fun_delay()
 {
       while (struct event_*cur = dequeue_())
-	    delete cur;
+	    delete_event_(cur);
+      if (spare_)
+	    delete_event_(spare_);
+}
+
+/*
+ * Get an event of the type that matches the type_ of the delay,
+ * reusing the spare event if there is one.
+ */
+struct vvp_fun_delay::event_* vvp_fun_delay::alloc_event_(vvp_time64_t sim_time)
+{
+      struct event_*cur = spare_;
+      if (cur) {
+	    spare_ = 0;
+      } else {
+	    switch (type_) {
+		case VEC4_DELAY:
+		  cur = new event_vec4_;
+		  break;
+		case VEC8_DELAY:
+		  cur = new event_vec8_;
+		  break;
+		case REAL_DELAY:
+		  cur = new event_real_;
+		  break;
+		default:
+		  assert(0);
+		  return 0;
+	    }
+      }
+
+      cur->sim_time = sim_time;
+      cur->next = 0;
+      return cur;
+}
+
+void vvp_fun_delay::free_event_(struct event_*cur)
+{
+      if (spare_ == 0)
+	    spare_ = cur;
+      else
+	    delete_event_(cur);
+}
+
+void vvp_fun_delay::delete_event_(struct event_*cur)
+{
+      switch (type_) {
+	  case VEC4_DELAY:
+	    delete static_cast<event_vec4_*>(cur);
+	    break;
+	  case VEC8_DELAY:
+	    delete static_cast<event_vec8_*>(cur);
+	    break;
+	  case REAL_DELAY:
+	    delete static_cast<event_real_*>(cur);
+	    break;
+	  default:
+	    assert(0);
+	    break;
+      }
 }
 
 bool vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay,
-                                        const vvp_vector4_t&bit)
+                                        const vvp_vector4_t&bit,
+                                        struct event_*&cancel)
 {
       if (list_ == 0) return false;
 
 	/* If the most recent event and the new event have the same
 	 * value then we need to skip the new event. */
-      if (list_->next->ptr_vec4.eeq(bit)) return true;
+      if (static_cast<event_vec4_*>(list_->next)->value.eeq(bit)) return true;
 
-      clean_pulse_events_(use_delay);
+      cancel = clean_pulse_events_(use_delay);
       return false;
 }
 
 bool vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay,
-                                        const vvp_vector8_t&bit)
+                                        const vvp_vector8_t&bit,
+                                        struct event_*&cancel)
 {
       if (list_ == 0) return false;
 
 	/* If the most recent event and the new event have the same
 	 * value then we need to skip the new event. */
-      if (list_->next->ptr_vec8.eeq(bit)) return true;
+      if (static_cast<event_vec8_*>(list_->next)->value.eeq(bit)) return true;
 
-      clean_pulse_events_(use_delay);
+      cancel = clean_pulse_events_(use_delay);
       return false;
 }
 
 bool vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay,
-                                        double bit)
+                                        double bit,
+                                        struct event_*&cancel)
 {
       if (list_ == 0) return false;
 
 	/* If the most recent event and the new event have the same
 	 * value then we need to skip the new event. */
-      if (list_->next->ptr_real == bit) return true;
+      if (static_cast<event_real_*>(list_->next)->value == bit) return true;
 
-      clean_pulse_events_(use_delay);
+      cancel = clean_pulse_events_(use_delay);
       return false;
 }
 
-void vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay)
+/*
+ * Cancel the scheduled events that the new event would turn into a
+ * pulse. Normally an inertial delay has only the one pending event,
+ * and that is returned still linked into the list so that the caller
+ * can overwrite it in place with the new value. Only when several
+ * events were queued during the current time step are the future
+ * events stripped from the head of the list.
+ */
+struct vvp_fun_delay::event_* vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay)
 {
       assert(list_ != 0);
 
-      do {
-	    struct event_*cur = list_->next;
-	      /* If this event is far enough from the event I'm about
-	         to create, then that scheduled event is not a pulse
-	         to be eliminated, so we're done. */
-	    if (cur->sim_time+use_delay <= use_delay+schedule_simtime())
-		  break;
+      struct event_*cur = list_->next;
+	/* If this event is far enough from the event I'm about to
+	   create, then that scheduled event is not a pulse to be
+	   eliminated, so there is nothing to do. */
+      if (cur->sim_time+use_delay <= use_delay+schedule_simtime())
+	    return 0;
 
+      if (cur == list_)
+	    return cur;
+
+      do {
 	    if (list_ == cur)
 		  list_ = 0;
 	    else
 		  list_->next = cur->next;
-	    delete cur;
-      } while (list_);
+	    free_event_(cur);
+	    if (list_ == 0)
+		  break;
+	    cur = list_->next;
+      } while (cur->sim_time+use_delay > use_delay+schedule_simtime());
+
+      return 0;
+}
+
+/*
+ * Return the event that carries a new value. If clean_pulse_events_
+ * cancelled the pending event then it is retimed in place, otherwise
+ * a fresh event is queued.
+ */
+struct vvp_fun_delay::event_* vvp_fun_delay::reschedule_(struct event_*cancel,
+							  vvp_time64_t sim_time)
+{
+      if (cancel) {
+	    cancel->sim_time = sim_time;
+	    return cancel;
+      }
+
+      struct event_*cur = alloc_event_(sim_time);
+      enqueue_(cur);
+      return cur;
+}
+
+/*
+ * The new value is not scheduled after all, so really remove the
+ * cancelled event. It is always the only event in the list.
+ */
+void vvp_fun_delay::drop_cancelled_(struct event_*cancel)
+{
+      if (cancel == 0)
+	    return;
+
+      assert(list_ == cancel && cancel->next == cancel);
+      list_ = 0;
+      free_event_(cancel);
 }
 
 /*
@@ -294,7 +457,7 @@ void vvp_fun_delay::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
 	      // current value of the output. Detect and handle the
 	      // special case that the event list contains the current
 	      // value as a zero-delay-remaining event.
-	    const vvp_vector4_t&use_vec4 = (list_ && list_->next->sim_time == schedule_simtime())? list_->next->ptr_vec4 : cur_vec4_;
+	    const vvp_vector4_t&use_vec4 = (list_ && list_->next->sim_time == schedule_simtime())? static_cast<event_vec4_*>(list_->next)->value : cur_vec4_;
 
 	      /* How many bits to compare? */
 	    unsigned use_wid = use_vec4.size();
@@ -314,20 +477,20 @@ void vvp_fun_delay::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
       /* what *should* happen here is we check to see if there is a
          transaction in the queue. This would be a pulse that needs to be
          eliminated. */
-      if (clean_pulse_events_(use_delay, bit)) return;
+      struct event_*cancel = 0;
+      if (clean_pulse_events_(use_delay, bit, cancel)) return;
 
       vvp_time64_t use_simtime = schedule_simtime() + use_delay;
 
 	/* And propagate it. */
-      if (use_delay == 0 && list_ == 0) {
+      if (use_delay == 0 && list_ == cancel) {
+	    drop_cancelled_(cancel);
 	    cur_vec4_ = bit;
 	    initial_ = false;
 	    net_->send_vec4(cur_vec4_, 0);
       } else {
-	    struct event_*cur = new struct event_(use_simtime);
-	    cur->run_run_ptr = &vvp_fun_delay::run_run_vec4_;
-	    cur->ptr_vec4 = bit;
-	    enqueue_(cur);
+	    event_vec4_*cur = static_cast<event_vec4_*>(reschedule_(cancel, use_simtime));
+	    cur->value = bit;
 	    schedule_generic(this, use_delay, false);
       }
 }
@@ -364,7 +527,7 @@ void vvp_fun_delay::recv_vec8(vvp_net_ptr_t port, const vvp_vector8_t&bit)
 	      // current value of the output. Detect and handle the
 	      // special case that the event list contains the current
 	      // value as a zero-delay-remaining event.
-	    const vvp_vector8_t&use_vec8 = (list_ && list_->next->sim_time == schedule_simtime())? list_->next->ptr_vec8 : cur_vec8_;
+	    const vvp_vector8_t&use_vec8 = (list_ && list_->next->sim_time == schedule_simtime())? static_cast<event_vec8_*>(list_->next)->value : cur_vec8_;
 
 	      /* How many bits to compare? */
 	    unsigned use_wid = use_vec8.size();
@@ -386,20 +549,20 @@ void vvp_fun_delay::recv_vec8(vvp_net_ptr_t port, const vvp_vector8_t&bit)
       /* what *should* happen here is we check to see if there is a
          transaction in the queue. This would be a pulse that needs to be
          eliminated. */
-      if (clean_pulse_events_(use_delay, bit)) return;
+      struct event_*cancel = 0;
+      if (clean_pulse_events_(use_delay, bit, cancel)) return;
 
       vvp_time64_t use_simtime = schedule_simtime() + use_delay;
 
 	/* And propagate it. */
-      if (use_delay == 0 && list_ == 0) {
+      if (use_delay == 0 && list_ == cancel) {
+	    drop_cancelled_(cancel);
 	    cur_vec8_ = bit;
 	    initial_ = false;
 	    net_->send_vec8(cur_vec8_);
       } else {
-	    struct event_*cur = new struct event_(use_simtime);
-	    cur->ptr_vec8 = bit;
-	    cur->run_run_ptr = &vvp_fun_delay::run_run_vec8_;
-	    enqueue_(cur);
+	    event_vec8_*cur = static_cast<event_vec8_*>(reschedule_(cancel, use_simtime));
+	    cur->value = bit;
 	    schedule_generic(this, use_delay, false);
       }
 }
@@ -451,23 +614,26 @@ void vvp_fun_delay::recv_real(vvp_net_ptr_t port, double bit,
       use_delay = delay_.get_min_delay();
 
       /* Eliminate glitches. */
-      if (clean_pulse_events_(use_delay, bit)) return;
+      struct event_*cancel = 0;
+      if (clean_pulse_events_(use_delay, bit, cancel)) return;
 
       /* This must be done after cleaning pulses to avoid propagating
        * an incorrect value. */
-      if (cur_real_ == bit) return;
+      if (cur_real_ == bit) {
+	    drop_cancelled_(cancel);
+	    return;
+      }
 
       vvp_time64_t use_simtime = schedule_simtime() + use_delay;
 
-      if (use_delay == 0 && list_ == 0) {
+      if (use_delay == 0 && list_ == cancel) {
+	    drop_cancelled_(cancel);
 	    cur_real_ = bit;
 	    initial_ = false;
 	    net_->send_real(cur_real_, 0);
       } else {
-	    struct event_*cur = new struct event_(use_simtime);
-	    cur->run_run_ptr = &vvp_fun_delay::run_run_real_;
-	    cur->ptr_real = bit;
-	    enqueue_(cur);
+	    event_real_*cur = static_cast<event_real_*>(reschedule_(cancel, use_simtime));
+	    cur->value = bit;
 
 	    schedule_generic(this, use_delay, false);
       }
@@ -483,26 +649,39 @@ void vvp_fun_delay::run_run()
       if (cur == 0)
 	    return;
 
-      (this->*(cur->run_run_ptr))(cur);
+      switch (type_) {
+	  case VEC4_DELAY:
+	    run_run_vec4_(static_cast<event_vec4_*>(cur));
+	    break;
+	  case VEC8_DELAY:
+	    run_run_vec8_(static_cast<event_vec8_*>(cur));
+	    break;
+	  case REAL_DELAY:
+	    run_run_real_(static_cast<event_real_*>(cur));
+	    break;
+	  default:
+	    assert(0);
+	    break;
+      }
       initial_ = false;
-      delete cur;
+      free_event_(cur);
 }
 
-void vvp_fun_delay::run_run_vec4_(struct event_*cur)
+void vvp_fun_delay::run_run_vec4_(struct vvp_fun_delay::event_vec4_*cur)
 {
-      cur_vec4_ = cur->ptr_vec4;
+      cur_vec4_ = cur->value;
       net_->send_vec4(cur_vec4_, 0);
 }
 
-void vvp_fun_delay::run_run_vec8_(struct vvp_fun_delay::event_*cur)
+void vvp_fun_delay::run_run_vec8_(struct vvp_fun_delay::event_vec8_*cur)
 {
-      cur_vec8_ = cur->ptr_vec8;
+      cur_vec8_ = cur->value;
       net_->send_vec8(cur_vec8_);
 }
 
-void vvp_fun_delay::run_run_real_(struct vvp_fun_delay::event_*cur)
+void vvp_fun_delay::run_run_real_(struct vvp_fun_delay::event_real_*cur)
 {
-      cur_real_ = cur->ptr_real;
+      cur_real_ = cur->value;
       net_->send_real(cur_real_, 0);
 }
 
@@ -75,18 +75,32 @@ class vvp_delay_t {
 class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
 
       enum delay_type_t {UNKNOWN_DELAY, VEC4_DELAY, VEC8_DELAY, REAL_DELAY};
+
+    public:
+	// The pending events. A delay only ever carries one type of
+	// value, so the events are specialized by the type of value
+	// they carry, and are allocated from per-type slabs. The
+	// type_ of the delay tells which kind of event is in the list.
+	// (These are public only so that the slabs can be declared.)
       struct event_ {
-	    explicit event_(vvp_time64_t s) : sim_time(s) {
-		  ptr_real = 0.0;
-		  next = NULL;
-	    }
-	    void (vvp_fun_delay::*run_run_ptr)(struct vvp_fun_delay::event_*cur);
-	    const vvp_time64_t sim_time;
-	    vvp_vector4_t ptr_vec4;
-	    vvp_vector8_t ptr_vec8;
-	    double ptr_real;
+	    vvp_time64_t sim_time;
 	    struct event_*next;
       };
+      struct event_vec4_ : public event_ {
+	    vvp_vector4_t value;
+	    static void* operator new(size_t);
+	    static void operator delete(void*);
+      };
+      struct event_vec8_ : public event_ {
+	    vvp_vector8_t value;
+	    static void* operator new(size_t);
+	    static void operator delete(void*);
+      };
+      struct event_real_ : public event_ {
+	    double value;
+	    static void* operator new(size_t);
+	    static void operator delete(void*);
+      };
 
     public:
       vvp_fun_delay(vvp_net_t*net, unsigned width, const vvp_delay_t&d);
@@ -109,9 +123,9 @@ class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
       virtual void run_run();
 
 
-      void run_run_vec4_(struct vvp_fun_delay::event_*cur);
-      void run_run_vec8_(struct vvp_fun_delay::event_*cur);
-      void run_run_real_(struct vvp_fun_delay::event_*cur);
+      void run_run_vec4_(struct vvp_fun_delay::event_vec4_*cur);
+      void run_run_vec8_(struct vvp_fun_delay::event_vec8_*cur);
+      void run_run_real_(struct vvp_fun_delay::event_real_*cur);
 
     private:
       vvp_net_t*net_;
@@ -125,6 +139,14 @@ class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
       vvp_time64_t round_, scale_; // Needed to scale variable time values.
 
       struct event_ *list_;
+	// An event that recently ran, kept to be reused by the next
+	// event that is scheduled without touching the allocator.
+      struct event_ *spare_;
+      struct event_*alloc_event_(vvp_time64_t sim_time);
+      void free_event_(struct event_*cur);
+      struct event_*reschedule_(struct event_*cancel, vvp_time64_t sim_time);
+      void drop_cancelled_(struct event_*cancel);
+      void delete_event_(struct event_*cur);
       void enqueue_(struct event_*cur)
       {
 	    if (list_) {
@@ -147,11 +169,14 @@ class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
 		  list_->next = cur->next;
 	    return cur;
       }
-      bool clean_pulse_events_(vvp_time64_t use_delay, const vvp_vector4_t&bit);
-      bool clean_pulse_events_(vvp_time64_t use_delay, const vvp_vector8_t&bit);
-      bool clean_pulse_events_(vvp_time64_t use_delay, double bit);
+      bool clean_pulse_events_(vvp_time64_t use_delay, const vvp_vector4_t&bit,
+                               struct event_*&cancel);
+      bool clean_pulse_events_(vvp_time64_t use_delay, const vvp_vector8_t&bit,
+                               struct event_*&cancel);
+      bool clean_pulse_events_(vvp_time64_t use_delay, double bit,
+                               struct event_*&cancel);
 // Delete this when done!
-      void clean_pulse_events_(vvp_time64_t use_delay);
+      struct event_*clean_pulse_events_(vvp_time64_t use_delay);
 };
 
 /*
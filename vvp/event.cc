@@ -226,10 +226,11 @@ bool vvp_fun_edge::recv_vec4_(const vvp_vector4_t&bit,
                               vvp_bit4_t&old_bit, vthread_t&threads)
 {
 	/* See what kind of edge this represents. */
-      edge_t mask = VVP_EDGE(old_bit, bit.value(0));
+      vvp_bit4_t new_bit = bit.value(0);
+      edge_t mask = VVP_EDGE(old_bit, new_bit);
 
 	/* Save the current input for the next time around. */
-      old_bit = bit.value(0);
+      old_bit = new_bit;
 
       if ((edge_ == vvp_edge_none) || (edge_ & mask)) {
 	    run_waiting_threads_(threads);
@@ -386,12 +387,10 @@ bool vvp_fun_anyedge::recv_vec4_(const vvp_vector4_t&bit,
 	    }
 
       } else {
-	    for (unsigned idx = 0 ;  idx < bit.size() ;  idx += 1) {
-		  if (old_bits.value(idx) != bit.value(idx)) {
-			flag = true;
-			break;
-		  }
-	    }
+	      // Compare whole words at a time. If this is a change,
+	      // the copy below shares a wide value instead of
+	      // duplicating it.
+	    flag = ! old_bits.eeq(bit);
       }
 
       if (flag) {
@@ -443,15 +442,28 @@ void vvp_fun_anyedge_sa::recv_vec4_pv(vvp_net_ptr_t port, const vvp_vector4_t&bi
 				      unsigned base, unsigned wid, unsigned vwid,
 				      vvp_context_t)
 {
-      vvp_vector4_t tmp = bits_[port.port()];
-      if (tmp.size() == 0)
-	    tmp = vvp_vector4_t(vwid, BIT4_Z);
+      vvp_vector4_t&old_bits = bits_[port.port()];
       assert(wid == bit.size());
       assert(base+wid <= vwid);
-      assert(tmp.size() == vwid);
+
+	/* Once we have seen a value, the part can be written straight
+	   into the saved vector. The set_vec reports whether any bit
+	   actually changed, so there is no need to build and compare
+	   a copy of the whole vector. */
+      if (old_bits.size() != 0) {
+	    assert(old_bits.size() == vwid);
+	    if (old_bits.set_vec(base, bit)) {
+		  run_waiting_threads_(threads_);
+		  vvp_net_t*net = port.ptr();
+		  net->send_vec4(bit, 0);
+	    }
+	    return;
+      }
+
+      vvp_vector4_t tmp (vwid, BIT4_Z);
       tmp.set_vec(base, bit);
 
-      if (recv_vec4_(tmp, bits_[port.port()], threads_)) {
+      if (recv_vec4_(tmp, old_bits, threads_)) {
 	    vvp_net_t*net = port.ptr();
 	    net->send_vec4(bit, 0);
       }
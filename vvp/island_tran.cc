@@ -22,17 +22,50 @@
 # include  "symbols.h"
 # include  "schedule.h"
 # include  <list>
+# include  <map>
+# include  <vector>
 
 # include  <iostream>
 
 using namespace std;
 
+struct vvp_island_branch_tran;
+
+/*
+ * The branches of a tran island are split into components, which are
+ * the sets of branches that are connected together through their
+ * ports. The value of a port can only be affected by the branches in
+ * its own component, so when a port is flagged only the components
+ * that use that port (as a branch end or as a branch enable) need to
+ * be resolved again.
+ */
 class vvp_island_tran : public vvp_island {
 
     public:
+      vvp_island_tran();
+
       void run_island();
       void count_drivers(vvp_island_port*port, unsigned bit_idx,
                          unsigned counts[3]);
+
+    private:
+      struct component_t {
+	    std::vector<vvp_island_branch_tran*> branches;
+	    bool dirty;
+      };
+
+      void make_components_(void);
+      void mark_dirty_(vvp_island_port*port);
+
+      bool components_valid_;
+      std::vector<component_t> components_;
+	// The components to run the next time the island runs.
+      std::vector<unsigned> dirty_;
+	// Map the ports to the components that use them.
+      std::map<vvp_island_port*,std::vector<unsigned> > port_map_;
+	// Map the ports to the components that have branches that
+	// use the port as an enable.
+      std::map<vvp_island_port*,std::vector<unsigned> > enable_map_;
 };
 
 enum tran_state_t {
@@ -48,7 +81,7 @@ struct vvp_island_branch_tran : public vvp_island_branch {
                              unsigned offset__, bool resistive__);
       bool run_test_enabled();
       void run_resolution();
-      void run_output();
+      void run_output(std::vector<vvp_island_port*>&changed);
 
       vvp_net_t*en;
       unsigned width, part, offset;
@@ -75,35 +108,172 @@ static inline vvp_island_branch_tran* BRANCH_TRAN(vvp_island_branch*tmp)
       return res;
 }
 
+vvp_island_tran::vvp_island_tran()
+: components_valid_(false)
+{
+}
+
+/*
+ * Split the branches into connected components. The branches are
+ * merged with a union-find over the branch list, using the port nets
+ * at the branch ends to find the branches that touch.
+ */
+void vvp_island_tran::make_components_(void)
+{
+      vector<vvp_island_branch_tran*> branches;
+      for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch)
+	    branches.push_back(BRANCH_TRAN(cur));
+
+      vector<unsigned> parent (branches.size());
+      for (unsigned idx = 0 ; idx < parent.size() ; idx += 1)
+	    parent[idx] = idx;
+
+      map<vvp_net_t*,unsigned> net_branch;
+      for (unsigned idx = 0 ; idx < branches.size() ; idx += 1) {
+	    vvp_net_t*ends[2] = { branches[idx]->a, branches[idx]->b };
+	    for (unsigned ab = 0 ; ab < 2 ; ab += 1) {
+		  map<vvp_net_t*,unsigned>::iterator cur = net_branch.find(ends[ab]);
+		  if (cur == net_branch.end()) {
+			net_branch[ends[ab]] = idx;
+			continue;
+		  }
+
+		  unsigned ra = cur->second;
+		  while (parent[ra] != ra)
+			ra = parent[ra] = parent[parent[ra]];
+		  unsigned rb = idx;
+		  while (parent[rb] != rb)
+			rb = parent[rb] = parent[parent[rb]];
+		  parent[rb] = ra;
+	    }
+      }
+
+      vector<unsigned> comp_of_root (branches.size(), (unsigned)-1);
+      for (unsigned idx = 0 ; idx < branches.size() ; idx += 1) {
+	    unsigned root = idx;
+	    while (parent[root] != root)
+		  root = parent[root];
+
+	    if (comp_of_root[root] == (unsigned)-1) {
+		  comp_of_root[root] = components_.size();
+		  components_.push_back(component_t());
+		  components_.back().dirty = false;
+	    }
+
+	    unsigned comp = comp_of_root[root];
+	    vvp_island_branch_tran*br = branches[idx];
+	    components_[comp].branches.push_back(br);
+
+	    vector<unsigned>&ua = port_map_[dynamic_cast<vvp_island_port*>(br->a->fun)];
+	    if (ua.empty() || ua.back() != comp)
+		  ua.push_back(comp);
+	    vector<unsigned>&ub = port_map_[dynamic_cast<vvp_island_port*>(br->b->fun)];
+	    if (ub.empty() || ub.back() != comp)
+		  ub.push_back(comp);
+
+	    if (br->en) {
+		  vvp_island_port*ep = dynamic_cast<vvp_island_port*>(br->en->fun);
+		  vector<unsigned>&ue = enable_map_[ep];
+		  if (ue.empty() || ue.back() != comp)
+			ue.push_back(comp);
+		  vector<unsigned>&up = port_map_[ep];
+		  if (up.empty() || up.back() != comp)
+			up.push_back(comp);
+	    }
+      }
+
+      count_components_ = components_.size();
+      components_valid_ = true;
+
+	// The first run of the island must resolve everything.
+      for (unsigned idx = 0 ; idx < components_.size() ; idx += 1) {
+	    components_[idx].dirty = true;
+	    dirty_.push_back(idx);
+      }
+}
+
+void vvp_island_tran::mark_dirty_(vvp_island_port*port)
+{
+      map<vvp_island_port*,vector<unsigned> >::const_iterator cur = port_map_.find(port);
+      if (cur == port_map_.end())
+	    return;
+
+      for (unsigned idx = 0 ; idx < cur->second.size() ; idx += 1) {
+	    unsigned comp = cur->second[idx];
+	    if (components_[comp].dirty)
+		  continue;
+	    components_[comp].dirty = true;
+	    dirty_.push_back(comp);
+      }
+}
+
 /*
  * The run_island() method is called by the scheduler to run the
- * entire island. We run the island by calling run_resolution() for
- * all the branches in the island.
+ * island. We run the island by calling run_resolution() for all the
+ * branches in the components that were affected by the flagged ports.
 */
 void vvp_island_tran::run_island()
 {
+      if (! components_valid_)
+	    make_components_();
+
+      for (unsigned idx = 0 ; idx < flagged_ports_.size() ; idx += 1) {
+	    flagged_ports_[idx]->flagged = false;
+	    mark_dirty_(flagged_ports_[idx]);
+      }
+      flagged_ports_.clear();
+
+      if (dirty_.empty())
+	    return;
+
+      vector<unsigned> run_list;
+      run_list.swap(dirty_);
+      for (unsigned idx = 0 ; idx < run_list.size() ; idx += 1)
+	    components_[run_list[idx]].dirty = false;
+
+      count_runs_ += 1;
+
 	// Test to see if any of the branches are enabled. This loop
 	// tests the enabled inputs for all the branches and caches
 	// the results in the state for each branch.
-      bool runnable = false;
-      for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch) {
-	    vvp_island_branch_tran*tmp = dynamic_cast<vvp_island_branch_tran*>(cur);
-	    assert(tmp);
-	    runnable |= tmp->run_test_enabled();
+      for (unsigned idx = 0 ; idx < run_list.size() ; idx += 1) {
+	    component_t&comp = components_[run_list[idx]];
+	    for (unsigned bdx = 0 ; bdx < comp.branches.size() ; bdx += 1)
+		  comp.branches[bdx]->run_test_enabled();
+	    count_visits_ += comp.branches.size();
       }
 
-	// Now resolve all the branches in the island.
-      for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch) {
-	    vvp_island_branch_tran*tmp = dynamic_cast<vvp_island_branch_tran*>(cur);
-	    assert(tmp);
-	    tmp->run_resolution();
+	// Now resolve all the branches in those components.
+      for (unsigned idx = 0 ; idx < run_list.size() ; idx += 1) {
+	    component_t&comp = components_[run_list[idx]];
+	    for (unsigned bdx = 0 ; bdx < comp.branches.size() ; bdx += 1)
+		  comp.branches[bdx]->run_resolution();
       }
 
 	// Now output the resolved values.
-      for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch) {
-	    vvp_island_branch_tran*tmp = dynamic_cast<vvp_island_branch_tran*>(cur);
-	    assert(tmp);
-	    tmp->run_output();
+      vector<vvp_island_port*> changed;
+      for (unsigned idx = 0 ; idx < run_list.size() ; idx += 1) {
+	    component_t&comp = components_[run_list[idx]];
+	    for (unsigned bdx = 0 ; bdx < comp.branches.size() ; bdx += 1)
+		  comp.branches[bdx]->run_output(changed);
+      }
+
+	// The enables of branches may read the resolved value of a
+	// port, so if that changed, then the components with those
+	// branches must be run again. As before, they will see the
+	// new value the next time the island runs.
+      for (unsigned idx = 0 ; idx < changed.size() ; idx += 1) {
+	    map<vvp_island_port*,vector<unsigned> >::const_iterator cur
+		  = enable_map_.find(changed[idx]);
+	    if (cur == enable_map_.end())
+		  continue;
+	    for (unsigned cdx = 0 ; cdx < cur->second.size() ; cdx += 1) {
+		  unsigned comp = cur->second[cdx];
+		  if (components_[comp].dirty)
+			continue;
+		  components_[comp].dirty = true;
+		  dirty_.push_back(comp);
+	    }
       }
 }
 
@@ -375,7 +545,7 @@ void vvp_island_branch_tran::run_resolution()
       }
 }
 
-void vvp_island_branch_tran::run_output()
+void vvp_island_branch_tran::run_output(vector<vvp_island_port*>&changed)
 {
       vvp_island_port*port;
 
@@ -383,6 +553,8 @@ void vvp_island_branch_tran::run_output()
         // resolved value to the output.
       port = dynamic_cast<vvp_island_port*>(a->fun);
       if (port->value.size() != 0) {
+	    if (! port->outvalue.eeq(port->value))
+		  changed.push_back(port);
 	    island_send_value(a, port->value);
 	    port->value = vvp_vector8_t::nil;
       }
@@ -390,6 +562,8 @@ void vvp_island_branch_tran::run_output()
 	// Do the same for the B side port.
       port = dynamic_cast<vvp_island_port*>(b->fun);
       if (port->value.size() != 0) {
+	    if (! port->outvalue.eeq(port->value))
+		  changed.push_back(port);
 	    island_send_value(b, port->value);
 	    port->value = vvp_vector8_t::nil;
       }
@@ -27,6 +27,11 @@
 # include  "statistics.h"
 # include  "vvp_cleanup.h"
 # include  "vvp_object.h"
+# include  "vvp_island.h"
+# include  "profile.h"
+#ifdef VVP_OPCODE_STATS
+# include  "vthread.h"
+#endif
 # include  <cstdio>
 # include  <cstdlib>
 # include  <cstring>
@@ -58,6 +63,7 @@ extern "C" const char*optarg;
 
 bool verbose_flag = false;
 bool version_flag = false;
+static bool async_output_flag = false;
 static int vvp_return_value = 0;
 
 void vpip_set_return_value(int value)
@@ -226,6 +232,7 @@ static void final_cleanup()
       signal_pool_delete();
       vvp_net_pool_delete();
       ufunc_pool_delete();
+      delay_pool_delete();
 #endif
 	/*
 	 * Unload the VPI modules. This is essential for MinGW, to ensure
@@ -248,6 +255,7 @@ unsigned module_cnt = 0;
 const char*module_tab[64];
 
 extern void vpip_mcd_init(FILE *log);
+extern void vpip_mcd_async_init(void);
 extern void vvp_vpi_init(void);
 
 int main(int argc, char*argv[])
@@ -257,6 +265,8 @@ int main(int argc, char*argv[])
       const char*design_path = 0;
       struct rusage cycles[3];
       const char *logfile_name = 0x0;
+      const char *profile_path = 0;
+      const char *trace_path = 0;
       FILE *logfile = 0x0;
       extern void vpi_set_vlog_info(int, char**);
       extern bool stop_is_finish;
@@ -278,11 +288,15 @@ int main(int argc, char*argv[])
         /* For non-interactive runs we do not want to run the interactive
          * debugger, so make $stop just execute a $finish. */
       stop_is_finish = false;
-      while ((opt = getopt(argc, argv, "+hil:M:m:nNsvV")) != EOF) switch (opt) {
+      while ((opt = getopt(argc, argv, "+bhil:M:m:nNp:st:vV")) != EOF) switch (opt) {
+	  case 'b':
+	    async_output_flag = true;
+	    break;
          case 'h':
            fprintf(stderr,
                    "Usage: vvp [options] input-file [+plusargs...]\n"
                    "Options:\n"
+                   " -b             Write $fopen MCD files from a background thread.\n"
                    " -h             Print this help message.\n"
                    " -i             Interactive mode (unbuffered stdio).\n"
                    " -l file        Logfile, '-' for <stderr>\n"
@@ -291,7 +305,9 @@ int main(int argc, char*argv[])
                    " -m module      Load vpi module.\n"
 		   " -n             Non-interactive ($stop = $finish).\n"
                    " -N             Same as -n, but exit code is 1 instead of 0\n"
+                   " -p file        Profile the simulation, write the report to file.\n"
 		   " -s             $stop right away.\n"
+                   " -t file        Write a trace of the events in each time step to file.\n"
                    " -v             Verbose progress messages.\n"
                    " -V             Print the version information.\n" );
            exit(0);
@@ -318,9 +334,15 @@ int main(int argc, char*argv[])
             stop_is_finish = true;
             stop_is_finish_exit_code = 1;
             break;
+	  case 'p':
+	    profile_path = optarg;
+	    break;
 	  case 's':
 	    schedule_stop(0);
 	    break;
+	  case 't':
+	    trace_path = optarg;
+	    break;
 	  case 'v':
 	    verbose_flag = true;
 	    break;
@@ -390,6 +412,8 @@ int main(int argc, char*argv[])
       }
 
       vpip_mcd_init(logfile);
+      if (async_output_flag)
+	    vpip_mcd_async_init();
 
       if (verbose_flag) {
 	    my_getrusage(cycles+0);
@@ -462,8 +486,18 @@ int main(int argc, char*argv[])
       }
 
 
+      if (trace_path && !schedule_trace_open(trace_path)) {
+	    fprintf(stderr, "%s: Unable to open trace file %s\n",
+		    argv[0], trace_path);
+      }
+
+      if (profile_path)
+	    profile_start(profile_path);
+
       schedule_simulate();
 
+      profile_finish();
+
       if (verbose_flag) {
 	    my_getrusage(cycles+2);
 	    print_rusage(cycles+2, cycles+1);
@@ -487,6 +521,20 @@ int main(int argc, char*argv[])
 			   count_assign_arword_pool());
 	    vpi_mcd_printf(1, "    %8lu other events (pool=%lu)\n",
 			   count_gen_events, count_gen_pool());
+	    vpi_mcd_printf(1, "    %8lu delta cycles (max %lu in one step,"
+			   " at time %" TIME_FMT_U ")\n",
+			   count_delta_cycles, count_max_step_deltas,
+			   count_max_step_deltas_time);
+	    vpi_mcd_printf(1, "    %8lu vector4 allocations (%lu copies shared)\n",
+			   count_vector4_allocs, count_vector4_shares);
+	    vpi_mcd_printf(1, "    %8lu class objects (%lu blocks allocated)\n",
+			   count_cobject_new, count_cobject_blocks);
+	    vpi_mcd_printf(1, "    %8lu coalesced stores (%lu propagated)\n",
+			   count_coalesce_stores, count_coalesce_flushes);
+	    island_print_statistics();
+#ifdef VVP_OPCODE_STATS
+	    vthread_print_opcode_stats();
+#endif
       }
 
       final_cleanup();
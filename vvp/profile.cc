@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "config.h"
+# include  "profile.h"
+# include  "vthread.h"
+# include  "codes.h"
+# include  "vpi_priv.h"
+# include  <map>
+# include  <string>
+# include  <vector>
+# include  <algorithm>
+# include  <typeinfo>
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <csignal>
+#if !defined(__MINGW32__)
+# include  <sys/time.h>
+#endif
+#if defined(__GNUC__)
+# include  <cxxabi.h>
+#endif
+
+using namespace std;
+
+bool profile_flag = false;
+
+/*
+ * The sample timer interval, in microseconds of CPU time.
+ */
+static const long PROFILE_INTERVAL = 1000;
+
+/*
+ * The timer signal handler cannot allocate or use the maps, so it
+ * only records each sample into this fixed buffer. The samples are
+ * moved into the maps (drained) from the normal flow of the
+ * simulation when the buffer is half full, and at the end.
+ */
+struct profile_sample_s {
+      __vpiScope*scope;
+      vvp_code_t pc;
+      const type_info*fun_type;
+};
+
+static const unsigned PROFILE_BUFFER = 8192;
+static profile_sample_s profile_samples[PROFILE_BUFFER];
+static volatile sig_atomic_t profile_sample_count = 0;
+static volatile unsigned long profile_samples_dropped = 0;
+
+  /* The types of the functors that are receiving values. A functor
+     may send to other functors while it receives, so this is a
+     stack. Only the first entries are kept if it gets very deep. */
+static const unsigned PROFILE_TYPE_STACK = 64;
+static const type_info* volatile profile_types[PROFILE_TYPE_STACK];
+static volatile sig_atomic_t profile_type_depth = 0;
+
+struct profile_scope_s {
+      unsigned long samples;
+      unsigned long runs;
+};
+
+struct profile_functor_s {
+      unsigned long samples;
+      unsigned long values;
+};
+
+static const char*profile_path = 0;
+static unsigned long profile_total = 0;
+static map<__vpiScope*,profile_scope_s> profile_scopes;
+static map<vvp_code_t,unsigned long> profile_lines;
+  /* The %file_line instruction for each sampled code address. */
+static map<vvp_code_t,vvp_code_t> profile_pc_lines;
+static map<const type_info*,profile_functor_s> profile_functors;
+  /* Collapsed stacks are made when the samples are drained. */
+static map<string,unsigned long> profile_stacks;
+
+  /* Cache the last scope and functor type looked up. */
+static __vpiScope*profile_last_scope = 0;
+static profile_scope_s*profile_last_scope_ent = 0;
+static const type_info*profile_last_type = 0;
+static profile_functor_s*profile_last_type_ent = 0;
+
+static void profile_drain(void);
+
+static string type_name(const type_info*type)
+{
+      const char*name = type->name();
+#if defined(__GNUC__)
+      int status = 0;
+      char*tmp = abi::__cxa_demangle(name, 0, 0, &status);
+      if (tmp && status == 0) {
+	    string res = tmp;
+	    free(tmp);
+	    return res;
+      }
+#endif
+      return name;
+}
+
+/*
+ * Make a frame name for a collapsed stack. The frames are separated
+ * by ';' and the count follows the last space, so replace those.
+ */
+static string frame_name(const char*text)
+{
+      string res = text;
+      for (size_t idx = 0 ; idx < res.size() ; idx += 1) {
+	    if (res[idx] == ';' || res[idx] == ' ')
+		  res[idx] = '_';
+      }
+      return res;
+}
+
+static string scope_stack(__vpiScope*scope)
+{
+      vector<__vpiScope*> path;
+      for (__vpiScope*cur = scope ; cur ; cur = cur->scope)
+	    path.push_back(cur);
+
+      string res;
+      for (size_t idx = path.size() ; idx > 0 ; idx -= 1) {
+	    if (! res.empty()) res += ";";
+	    res += frame_name(path[idx-1]->vpi_get_str(vpiName));
+      }
+      return res;
+}
+
+static string file_line_name(vvp_code_t cp)
+{
+      char buf[64];
+      snprintf(buf, sizeof buf, ":%d", (int)vpi_get(vpiLineNo, cp->handle));
+      return string(vpi_get_str(vpiFile, cp->handle)) + buf;
+}
+
+static profile_scope_s& scope_entry(__vpiScope*scope)
+{
+      if (scope != profile_last_scope || profile_last_scope_ent == 0) {
+	    profile_last_scope = scope;
+	    profile_last_scope_ent = &profile_scopes[scope];
+      }
+      return *profile_last_scope_ent;
+}
+
+static profile_functor_s& functor_entry(const type_info*type)
+{
+      if (type != profile_last_type || profile_last_type_ent == 0) {
+	    profile_last_type = type;
+	    profile_last_type_ent = &profile_functors[type];
+      }
+      return *profile_last_type_ent;
+}
+
+void profile_thread_run(__vpiScope*scope)
+{
+      scope_entry(scope).runs += 1;
+
+      if (profile_sample_count >= (sig_atomic_t)PROFILE_BUFFER/2)
+	    profile_drain();
+}
+
+void profile_functor(vvp_net_fun_t*fun)
+{
+      const type_info*type = &typeid(*fun);
+      functor_entry(type).values += 1;
+
+      sig_atomic_t depth = profile_type_depth;
+      if (depth < (sig_atomic_t)PROFILE_TYPE_STACK)
+	    profile_types[depth] = type;
+      profile_type_depth = depth + 1;
+
+      if (profile_sample_count >= (sig_atomic_t)PROFILE_BUFFER/2)
+	    profile_drain();
+}
+
+void profile_functor_done(void)
+{
+      if (profile_type_depth > 0)
+	    profile_type_depth = profile_type_depth - 1;
+}
+
+void profile_dispatch(void)
+{
+      profile_type_depth = 0;
+}
+
+#if !defined(__MINGW32__)
+
+static void profile_sigprof(int)
+{
+      sig_atomic_t idx = profile_sample_count;
+      if (idx >= (sig_atomic_t)PROFILE_BUFFER) {
+	    profile_samples_dropped = profile_samples_dropped + 1;
+	    return;
+      }
+
+      profile_sample_s&cur = profile_samples[idx];
+      if (! vthread_profile_point(cur.scope, cur.pc)) {
+	    sig_atomic_t depth = profile_type_depth;
+	    if (depth > (sig_atomic_t)PROFILE_TYPE_STACK)
+		  depth = PROFILE_TYPE_STACK;
+	    cur.scope = 0;
+	    cur.pc = 0;
+	    cur.fun_type = depth > 0? profile_types[depth-1] : 0;
+      } else {
+	    cur.fun_type = 0;
+      }
+
+      profile_sample_count = idx + 1;
+}
+
+static void profile_set_timer(long usec)
+{
+      struct itimerval val;
+      val.it_interval.tv_sec = 0;
+      val.it_interval.tv_usec = usec;
+      val.it_value = val.it_interval;
+      setitimer(ITIMER_PROF, &val, 0);
+}
+
+static void profile_block(bool flag, sigset_t*old)
+{
+      sigset_t set;
+      sigemptyset(&set);
+      sigaddset(&set, SIGPROF);
+      if (flag)
+	    sigprocmask(SIG_BLOCK, &set, old);
+      else
+	    sigprocmask(SIG_SETMASK, old, 0);
+}
+
+#endif
+
+/*
+ * Map a sampled code address to the statement that it is in, which
+ * is the last %file_line before the address in the code space. The
+ * address is the next instruction the thread will execute, so the
+ * search starts before it.
+ */
+static vvp_code_t pc_file_line(vvp_code_t pc)
+{
+      map<vvp_code_t,vvp_code_t>::iterator cur = profile_pc_lines.find(pc);
+      if (cur != profile_pc_lines.end())
+	    return cur->second;
+
+      vvp_code_t res = codespace_file_line(pc);
+      profile_pc_lines[pc] = res;
+      return res;
+}
+
+/*
+ * Move the samples from the signal buffer into the maps. The timer
+ * signal is blocked while the buffer is read and reset.
+ */
+static void profile_drain(void)
+{
+#if !defined(__MINGW32__)
+      sigset_t old;
+      profile_block(true, &old);
+#endif
+
+      unsigned count = profile_sample_count;
+      for (unsigned idx = 0 ; idx < count ; idx += 1) {
+	    const profile_sample_s&cur = profile_samples[idx];
+	    string stack;
+
+	    profile_total += 1;
+	    if (cur.scope) {
+		  scope_entry(cur.scope).samples += 1;
+		  stack = scope_stack(cur.scope);
+		  if (vvp_code_t file_line = pc_file_line(cur.pc)) {
+			profile_lines[file_line] += 1;
+			stack += ";" + frame_name(file_line_name(file_line).c_str());
+		  }
+	    } else if (cur.fun_type) {
+		  functor_entry(cur.fun_type).samples += 1;
+		  stack = "(nets);" + frame_name(type_name(cur.fun_type).c_str());
+	    } else {
+		  stack = "(scheduler)";
+	    }
+	    profile_stacks[stack] += 1;
+      }
+      profile_sample_count = 0;
+
+#if !defined(__MINGW32__)
+      profile_block(false, &old);
+#endif
+}
+
+void profile_start(const char*path)
+{
+      profile_path = path;
+      profile_flag = true;
+
+#if defined(__MINGW32__)
+      fprintf(stderr, "Warning: Profile sampling is not supported on this "
+                      "platform, only counts will be reported.\n");
+#else
+      struct sigaction act;
+      memset(&act, 0, sizeof act);
+      act.sa_handler = profile_sigprof;
+      act.sa_flags = SA_RESTART;
+      sigemptyset(&act.sa_mask);
+      sigaction(SIGPROF, &act, 0);
+
+      profile_set_timer(PROFILE_INTERVAL);
+#endif
+}
+
+template <class T> static bool more_samples(const T&a, const T&b)
+{
+      if (a.second.samples != b.second.samples)
+	    return a.second.samples > b.second.samples;
+      return a.first < b.first;
+}
+
+static bool more_line_samples(const pair<vvp_code_t,unsigned long>&a,
+			      const pair<vvp_code_t,unsigned long>&b)
+{
+      if (a.second != b.second)
+	    return a.second > b.second;
+      return a.first < b.first;
+}
+
+static bool more_values(const pair<const type_info*,profile_functor_s>&a,
+			const pair<const type_info*,profile_functor_s>&b)
+{
+      if (a.second.values != b.second.values)
+	    return a.second.values > b.second.values;
+      return a.second.samples > b.second.samples;
+}
+
+static double percent(unsigned long count)
+{
+      if (profile_total == 0)
+	    return 0.0;
+      return 100.0 * count / profile_total;
+}
+
+static void profile_write_report(FILE*fd)
+{
+      fprintf(fd, "Profile: %lu samples of %ld us CPU time",
+	      profile_total, PROFILE_INTERVAL);
+      if (profile_samples_dropped)
+	    fprintf(fd, " (%lu dropped)", (unsigned long)profile_samples_dropped);
+      fprintf(fd, "\n");
+
+      vector<pair<__vpiScope*,profile_scope_s> > scopes (profile_scopes.begin(),
+							profile_scopes.end());
+      sort(scopes.begin(), scopes.end(), more_samples<pair<__vpiScope*,profile_scope_s> >);
+
+      fprintf(fd, "\nScopes by samples:\n");
+      fprintf(fd, "%10s %7s %12s  %s\n", "samples", "%", "thread runs", "scope");
+      for (size_t idx = 0 ; idx < scopes.size() ; idx += 1) {
+	    fprintf(fd, "%10lu %6.2f%% %12lu  %s\n", scopes[idx].second.samples,
+		    percent(scopes[idx].second.samples),
+		    scopes[idx].second.runs,
+		    scopes[idx].first->vpi_get_str(vpiFullName));
+      }
+
+      if (! profile_lines.empty()) {
+	    vector<pair<vvp_code_t,unsigned long> > lines (profile_lines.begin(),
+							  profile_lines.end());
+	    sort(lines.begin(), lines.end(), more_line_samples);
+
+	    fprintf(fd, "\nSource lines by samples:\n");
+	    fprintf(fd, "%10s %7s  %s\n", "samples", "%", "line");
+	    for (size_t idx = 0 ; idx < lines.size() ; idx += 1) {
+		  vpiHandle handle = lines[idx].first->handle;
+		  string where = file_line_name(lines[idx].first);
+		  fprintf(fd, "%10lu %6.2f%%  %s: %s\n", lines[idx].second,
+			  percent(lines[idx].second), where.c_str(),
+			  vpi_get_str(_vpiDescription, handle));
+	    }
+      } else {
+	    fprintf(fd, "\n(Compile with -pfileline=1 to profile source lines.)\n");
+      }
+
+      vector<pair<const type_info*,profile_functor_s> > funs (profile_functors.begin(),
+							     profile_functors.end());
+      sort(funs.begin(), funs.end(), more_values);
+
+      fprintf(fd, "\nFunctors by values received:\n");
+      fprintf(fd, "%14s %10s %7s  %s\n", "values", "samples", "%", "functor");
+      for (size_t idx = 0 ; idx < funs.size() ; idx += 1) {
+	    fprintf(fd, "%14lu %10lu %6.2f%%  %s\n", funs[idx].second.values,
+		    funs[idx].second.samples, percent(funs[idx].second.samples),
+		    type_name(funs[idx].first).c_str());
+      }
+}
+
+void profile_finish(void)
+{
+      if (! profile_flag)
+	    return;
+
+#if !defined(__MINGW32__)
+      profile_set_timer(0);
+#endif
+      profile_drain();
+      profile_flag = false;
+
+      FILE*fd = fopen(profile_path, "w");
+      if (fd == 0) {
+	    perror(profile_path);
+	    return;
+      }
+      profile_write_report(fd);
+      fclose(fd);
+
+      string folded = string(profile_path) + ".folded";
+      fd = fopen(folded.c_str(), "w");
+      if (fd == 0) {
+	    perror(folded.c_str());
+	    return;
+      }
+      for (map<string,unsigned long>::const_iterator cur = profile_stacks.begin()
+		 ; cur != profile_stacks.end() ; ++ cur) {
+	    fprintf(fd, "%s %lu\n", cur->first.c_str(), cur->second);
+      }
+      fclose(fd);
+}
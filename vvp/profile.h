@@ -0,0 +1,68 @@
+#ifndef IVL_profile_H
+#define IVL_profile_H
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+class __vpiScope;
+class vvp_net_fun_t;
+
+/*
+ * The simulation profiler is enabled by the -p flag. A CPU time
+ * timer samples what the simulator is doing: the scope and code
+ * address of the running thread, or else the type of the functor
+ * that is receiving a value, or else the scheduler. The code address
+ * is mapped to a source line through the %file_line instructions, so
+ * the lines are only known if the design was compiled with
+ * -pfileline=1. The profiler also counts the thread runs in each
+ * scope and the values delivered to each functor type.
+ *
+ * The profile_flag is true while the profiler is running, and the
+ * hot paths check it before calling into the profiler.
+ */
+extern bool profile_flag;
+
+/*
+ * Start the profiler. The report is written to path, and the samples
+ * are written as collapsed stacks (for flame graph tools) to
+ * path.folded.
+ */
+extern void profile_start(const char*path);
+
+/*
+ * Stop the profiler and write the report files.
+ */
+extern void profile_finish(void);
+
+/*
+ * Count a run of a thread in the given scope.
+ */
+extern void profile_thread_run(__vpiScope*scope);
+
+/*
+ * Count a value delivered to the functor. The send loops call
+ * profile_functor before the functor receives the value and
+ * profile_functor_done after, so that samples are only charged to
+ * the functor while it works. The scheduler calls profile_dispatch
+ * before it runs each event, since no functor is working then.
+ */
+extern void profile_functor(vvp_net_fun_t*fun);
+extern void profile_functor_done(void);
+extern void profile_dispatch(void);
+
+#endif /* IVL_profile_H */
@@ -30,6 +30,10 @@
 # include  <cstdlib>
 # include  <cassert>
 # include  <iostream>
+# include  <cstdio>
+# include  <cstring>
+# include  <stdint.h>
+# include  <sys/time.h>
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
 # include  "ivl_alloc.h"
@@ -40,6 +44,10 @@ unsigned long count_gen_events = 0;
 unsigned long count_thread_events = 0;
   // Count the time events (A time cell created)
 unsigned long count_time_events = 0;
+  // Count the delta cycles, and note the time step that took the most.
+unsigned long count_delta_cycles = 0;
+unsigned long count_max_step_deltas = 0;
+vvp_time64_t count_max_step_deltas_time = 0;
 
 
 
@@ -1056,6 +1064,166 @@ static bool sim_at_rosync = false;
 bool schedule_at_rosync(void)
 { return sim_at_rosync; }
 
+/*
+ * The scheduler counts the work done in each time step. The events
+ * and delta cycles are always counted, because that costs no more
+ * than an increment. A delta cycle is a trip around the active,
+ * inactive, nbassign and rwsync queues: each time the active queue
+ * runs dry and one of the other queues is moved in to replace it.
+ *
+ * When the -t flag asks for a trace, the scheduler also counts the
+ * events moved in from each queue (events that are scheduled into
+ * the active queue directly are counted as active) and measures the
+ * wall time of the step, and writes a record for each time step to
+ * the trace file. The trace is text (CSV) if the file name ends in
+ * ".csv", and binary otherwise. The binary trace starts with the
+ * 8 byte magic "VVPSTEP1", then a 32 bit byte order mark 0x01020304
+ * and the 32 bit record size. The records follow in host byte order:
+ *
+ *    uint64_t time      simulation time, in simulation precision units
+ *    uint64_t wall_us   wall clock time for the step, in microseconds
+ *    uint32_t active
+ *    uint32_t inactive
+ *    uint32_t nbassign
+ *    uint32_t rwsync
+ *    uint32_t rosync
+ *    uint32_t deltas
+ */
+struct step_stats_s {
+      unsigned long events;
+      unsigned long inactive;
+      unsigned long nbassign;
+      unsigned long rwsync;
+      unsigned long rosync;
+      unsigned long deltas;
+};
+
+struct step_record_s {
+      uint64_t time;
+      uint64_t wall_us;
+      uint32_t active;
+      uint32_t inactive;
+      uint32_t nbassign;
+      uint32_t rwsync;
+      uint32_t rosync;
+      uint32_t deltas;
+};
+
+static struct step_stats_s step_stats;
+static FILE*sched_trace_fd = 0;
+static bool sched_trace_csv = false;
+static uint64_t step_start_us = 0;
+
+static uint64_t trace_wall_us(void)
+{
+      struct timeval tv;
+      gettimeofday(&tv, 0);
+      return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static uint32_t trace_count(unsigned long val)
+{
+      return val > 0xffffffffUL ? 0xffffffffU : (uint32_t)val;
+}
+
+  /* Count the events in a (circular) event queue. */
+static unsigned long queue_length(const struct event_s*list)
+{
+      if (list == 0)
+	    return 0;
+
+      unsigned long cnt = 1;
+      for (const struct event_s*cur = list->next ; cur != list ; cur = cur->next)
+	    cnt += 1;
+
+      return cnt;
+}
+
+bool schedule_trace_open(const char*path)
+{
+      sched_trace_fd = fopen(path, "wb");
+      if (sched_trace_fd == 0)
+	    return false;
+
+      size_t len = strlen(path);
+      sched_trace_csv = len >= 4 && strcmp(path+len-4, ".csv") == 0;
+
+      if (sched_trace_csv) {
+	    fprintf(sched_trace_fd, "time,wall_us,active,inactive,nbassign,"
+		    "rwsync,rosync,deltas\n");
+      } else {
+	    uint32_t bom = 0x01020304;
+	    uint32_t rsize = sizeof(struct step_record_s);
+	    fwrite("VVPSTEP1", 1, 8, sched_trace_fd);
+	    fwrite(&bom, sizeof bom, 1, sched_trace_fd);
+	    fwrite(&rsize, sizeof rsize, 1, sched_trace_fd);
+      }
+
+      return true;
+}
+
+static void write_step_record(uint64_t now_us)
+{
+      struct step_record_s rec;
+      unsigned long queued = step_stats.inactive + step_stats.nbassign
+	    + step_stats.rwsync;
+
+      rec.time = schedule_time;
+      rec.wall_us = now_us - step_start_us;
+      rec.active = trace_count(step_stats.events > queued
+			       ? step_stats.events - queued : 0);
+      rec.inactive = trace_count(step_stats.inactive);
+      rec.nbassign = trace_count(step_stats.nbassign);
+      rec.rwsync = trace_count(step_stats.rwsync);
+      rec.rosync = trace_count(step_stats.rosync);
+      rec.deltas = trace_count(step_stats.deltas);
+
+      if (sched_trace_csv) {
+	    fprintf(sched_trace_fd, "%" TIME_FMT_U ",%" TIME_FMT_U
+		    ",%u,%u,%u,%u,%u,%u\n",
+		    (vvp_time64_t)rec.time, (vvp_time64_t)rec.wall_us,
+		    rec.active, rec.inactive,
+		    rec.nbassign, rec.rwsync, rec.rosync, rec.deltas);
+      } else {
+	    fwrite(&rec, sizeof rec, 1, sched_trace_fd);
+      }
+}
+
+/*
+ * This is called when a time step is done, to fold its counts into
+ * the totals and write the trace record.
+ */
+static void finish_time_step(void)
+{
+      count_delta_cycles += step_stats.deltas;
+      if (step_stats.deltas > count_max_step_deltas) {
+	    count_max_step_deltas = step_stats.deltas;
+	    count_max_step_deltas_time = schedule_time;
+      }
+
+      if (sched_trace_fd) {
+	    uint64_t now_us = trace_wall_us();
+	    write_step_record(now_us);
+	    step_start_us = now_us;
+      }
+
+      memset(&step_stats, 0, sizeof step_stats);
+}
+
+  /* Move the next queue into the (empty) active queue. */
+static inline void promote_queue(struct event_time_s*ctim,
+				 struct event_s*&queue,
+				 unsigned long&count)
+{
+      ctim->active = queue;
+      queue = 0;
+      if (ctim->active) {
+	    step_stats.deltas += 1;
+	    if (sched_trace_fd)
+		  count += queue_length(ctim->active);
+      }
+}
+
 /*
  * The scheduler uses this function to drain the rosync events of the
  * current time. The ctim object is still in the event queue, because
@@ -1077,6 +1245,8 @@ static void run_rosync(struct event_time_s*ctim)
 		  ctim->rosync->next = cur->next;
 	    }
 
+	    step_stats.rosync += 1;
+	    if (profile_flag) profile_dispatch();
 	    cur->run_run();
 	    delete cur;
       }
@@ -1149,6 +1319,9 @@ void schedule_simulate(void)
       // process events and when done run the final blocks.
       run_finals = schedule_runnable;
 
+      if (sched_trace_fd)
+	    step_start_us = trace_wall_us();
+
       if (schedule_runnable) while (sched_list) {
 
 	    if (schedule_stopped_flag) {
@@ -1195,22 +1368,20 @@ void schedule_simulate(void)
 		 queues. If there are not events at all, then release
 		 the event_time object. */
 	    if (ctim->active == 0) {
-		  ctim->active = ctim->inactive;
-		  ctim->inactive = 0;
+		  promote_queue(ctim, ctim->inactive, step_stats.inactive);
 
 		  if (ctim->active == 0) {
-			ctim->active = ctim->nbassign;
-			ctim->nbassign = 0;
+			promote_queue(ctim, ctim->nbassign, step_stats.nbassign);
 
 			if (ctim->active == 0) {
-			      ctim->active = ctim->rwsync;
-			      ctim->rwsync = 0;
+			      promote_queue(ctim, ctim->rwsync, step_stats.rwsync);
 
 				/* If out of rw events, then run the rosync
 				   events and delete this time step. This also
 				   deletes threads as needed. */
 			      if (ctim->active == 0) {
 				    run_rosync(ctim);
+				    finish_time_step();
 				    sched_list = ctim->next;
 				    delete ctim;
 				    continue;
@@ -1235,11 +1406,21 @@ void schedule_simulate(void)
 		  schedule_single_step_flag = false;
 	    }
 
+	    step_stats.events += 1;
+	    if (profile_flag) profile_dispatch();
 	    cur->run_run();
 
 	    delete (cur);
       }
 
+	// Write out the step that was interrupted by $finish, if any.
+      if (sched_trace_fd) {
+	    if (step_stats.events || step_stats.rosync)
+		  finish_time_step();
+	    fclose(sched_trace_fd);
+	    sched_trace_fd = 0;
+      }
+
 	// Execute final events.
       schedule_runnable = run_finals;
       while (schedule_runnable && schedule_final_list) {
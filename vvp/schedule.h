@@ -201,6 +201,13 @@ extern bool schedule_stopped(void);
  */
 extern void stop_handler(int rc);
 
+/*
+ * Write a record of the activity in each time step to the trace file
+ * at path. See schedule.cc for the format. Return false if the file
+ * cannot be opened.
+ */
+extern bool schedule_trace_open(const char*path);
+
 /*
  * These are event counters for the sake of performance measurements.
  */
@@ -209,5 +216,8 @@ extern unsigned long count_gen_events;
 extern unsigned long count_prop_events;
 extern unsigned long count_thread_events;
 extern unsigned long count_event_pool;
+extern unsigned long count_delta_cycles;
+extern unsigned long count_max_step_deltas;
+extern vvp_time64_t count_max_step_deltas_time;
 
 #endif /* IVL_schedule_H */
@@ -35,5 +35,12 @@ unsigned long count_vpi_nets = 0;
 
 unsigned long count_vpi_scopes = 0;
 
+/*
+ * These count the bit arrays allocated for wide vvp_vector4_t
+ * values, and the copies that shared an existing array instead.
+ */
+unsigned long count_vector4_allocs = 0;
+unsigned long count_vector4_shares = 0;
+
 size_t size_opcodes = 0;
 
@@ -58,6 +58,15 @@ extern unsigned long count_assign_arword_pool(void);
 extern unsigned long count_gen_events;
 extern unsigned long count_gen_pool(void);
 
+extern unsigned long count_vector4_allocs;
+extern unsigned long count_vector4_shares;
+
+extern unsigned long count_cobject_new;
+extern unsigned long count_cobject_blocks;
+
+extern unsigned long count_coalesce_stores;
+extern unsigned long count_coalesce_flushes;
+
 extern size_t size_opcodes;
 extern size_t size_vvp_nets;
 extern size_t size_vvp_net_funs;
@@ -82,6 +82,71 @@ ostream& operator <<(ostream&o, const struct udp_levels_table&table)
       return o;
 }
 
+/*
+ * Return the index into a compiled UDP table for the input values
+ * in cur. Each position uses two bits: bit 0 is set for a 1 and bit 1
+ * is set for an x. The positions are spread 8 bits at a time.
+ */
+static unsigned long udp_table_index(const udp_levels_table&cur)
+{
+      static unsigned short spread[256];
+      static bool spread_init = false;
+
+      if (! spread_init) {
+	    for (unsigned val = 0 ; val < 256 ; val += 1) {
+		  unsigned short tmp = 0;
+		  for (unsigned bit = 0 ; bit < 8 ; bit += 1)
+			if (val & (1U << bit))
+			      tmp |= 1U << (2*bit);
+		  spread[val] = tmp;
+	    }
+	    spread_init = true;
+      }
+
+      unsigned long res = 0;
+      unsigned long mask1 = cur.mask1;
+      unsigned long maskx = cur.maskx;
+      for (unsigned sft = 0 ; mask1 | maskx ; sft += 16) {
+	    res |= (unsigned long)spread[mask1 & 0xff] << sft;
+	    res |= (unsigned long)spread[maskx & 0xff] << (sft+1);
+	    mask1 >>= 8;
+	    maskx >>= 8;
+      }
+
+      return res;
+}
+
+/*
+ * This is the inverse of udp_table_index. Make the levels table for
+ * the first wid positions of the table index idx. Return false if any
+ * position has both bits set, since those indices are never used.
+ */
+static bool udp_table_levels(unsigned long idx, unsigned wid,
+			     udp_levels_table&cur)
+{
+      cur.mask0 = 0;
+      cur.mask1 = 0;
+      cur.maskx = 0;
+      for (unsigned pp = 0 ; pp < wid ; pp += 1) {
+	    unsigned long mask_bit = 1UL << pp;
+	    switch ((idx >> (2*pp)) & 3) {
+		case 0:
+		  cur.mask0 |= mask_bit;
+		  break;
+		case 1:
+		  cur.mask1 |= mask_bit;
+		  break;
+		case 2:
+		  cur.maskx |= mask_bit;
+		  break;
+		default:
+		  return false;
+	    }
+      }
+
+      return true;
+}
+
 vvp_udp_s::vvp_udp_s(char*label, char*name__, unsigned ports,
                      vvp_bit4_t init, bool type)
 : name_(name__), ports_(ports), init_(init), seq_(type)
@@ -125,12 +190,22 @@ vvp_udp_comb_s::vvp_udp_comb_s(char*label, char*name__, unsigned ports)
       levels1_ = 0;
       nlevels0_ = 0;
       nlevels1_ = 0;
+      table_ = 0;
 }
 
 vvp_udp_comb_s::~vvp_udp_comb_s()
 {
       delete[] levels0_;
       delete[] levels1_;
+      delete[] table_;
+}
+
+vvp_bit4_t vvp_udp_comb_s::test_levels(const udp_levels_table&cur)
+{
+      if (table_)
+	    return (vvp_bit4_t) table_[udp_table_index(cur)];
+
+      return test_rows_(cur);
 }
 
 /*
@@ -151,7 +226,7 @@ vvp_udp_comb_s::~vvp_udp_comb_s()
  * the three bit positions is set in the cur input table, the bit
  * position will generate a match.
  */
-vvp_bit4_t vvp_udp_comb_s::test_levels(const udp_levels_table&cur)
+vvp_bit4_t vvp_udp_comb_s::test_rows_(const udp_levels_table&cur)
 {
 	/* To test for a row match, test that the mask0, mask1 and
 	   maskx vectors all have bits set where the matching
@@ -290,6 +365,20 @@ void vvp_udp_comb_s::compile_table(char**tab)
 
       assert(nrows0 == nlevels0_);
       assert(nrows1 == nlevels1_);
+
+	/* Compile all the possible inputs into a lookup table if
+	   the table is small enough. */
+      if (port_count() <= UDP_COMB_TABLE_PORTS) {
+	    unsigned long size = 1UL << (2*port_count());
+	    table_ = new unsigned char[size];
+	    for (unsigned long idx = 0 ;  idx < size ;  idx += 1) {
+		  udp_levels_table cur;
+		  if (udp_table_levels(idx, port_count(), cur))
+			table_[idx] = test_rows_(cur);
+		  else
+			table_[idx] = BIT4_X;
+	    }
+      }
 }
 
 vvp_udp_seq_s::vvp_udp_seq_s(char*label, char*name__,
@@ -313,6 +402,9 @@ vvp_udp_seq_s::vvp_udp_seq_s(char*label, char*name__,
       nedges0_ = 0;
       nedges1_ = 0;
       nedgesL_ = 0;
+
+      levels_table_ = 0;
+      edges_table_ = 0;
 }
 
 vvp_udp_seq_s::~vvp_udp_seq_s()
@@ -324,6 +416,8 @@ vvp_udp_seq_s::~vvp_udp_seq_s()
       delete[] edges0_;
       delete[] edges1_;
       delete[] edgesL_;
+      delete[] levels_table_;
+      delete[] edges_table_;
 }
 
 void edge_based_on_char(struct udp_edges_table&cur, char chr, unsigned pos)
@@ -670,6 +764,63 @@ void vvp_udp_seq_s::compile_table(char**tab)
       assert(idx_edg1 == nedges1_);
       assert(idx_edgL == nedgesL_);
 
+      if (port_count() <= UDP_SEQ_TABLE_PORTS)
+	    compile_lookup_();
+}
+
+/*
+ * Fill the levels_table_ and edges_table_ from the compiled rows. The
+ * tables are indexed by the inputs and the current output (in
+ * position port_count()). Each levels_table_ entry has 3*port_count()
+ * edges_table_ entries, one for each input position and previous
+ * value (0, 1 or x) of that input.
+ */
+void vvp_udp_seq_s::compile_lookup_(void)
+{
+      unsigned wid = port_count() + 1;
+      unsigned long size = 1UL << (2*wid);
+      unsigned nedge = 3 * port_count();
+
+      levels_table_ = new unsigned char[size];
+      edges_table_ = new unsigned char[size * nedge];
+
+      for (unsigned long idx = 0 ;  idx < size ;  idx += 1) {
+	    unsigned char*edges = edges_table_ + idx*nedge;
+	    udp_levels_table cur;
+	    if (! udp_table_levels(idx, wid, cur)) {
+		  levels_table_[idx] = BIT4_X;
+		  for (unsigned edx = 0 ;  edx < nedge ;  edx += 1)
+			edges[edx] = BIT4_X;
+		  continue;
+	    }
+
+	    levels_table_[idx] = test_levels_(cur);
+
+	      /* The prev table does not include the output position,
+		 just like the tables passed to calculate_output. */
+	    unsigned long in_mask = ~(-1UL << port_count());
+	    for (unsigned pp = 0 ;  pp < port_count() ;  pp += 1) {
+		  unsigned long mask_bit = 1UL << pp;
+		  for (unsigned pv = 0 ;  pv < 3 ;  pv += 1) {
+			udp_levels_table prev;
+			prev.mask0 = cur.mask0 & in_mask & ~mask_bit;
+			prev.mask1 = cur.mask1 & in_mask & ~mask_bit;
+			prev.maskx = cur.maskx & in_mask & ~mask_bit;
+			switch (pv) {
+			    case 0:
+			      prev.mask0 |= mask_bit;
+			      break;
+			    case 1:
+			      prev.mask1 |= mask_bit;
+			      break;
+			    default:
+			      prev.maskx |= mask_bit;
+			      break;
+			}
+			edges[3*pp + pv] = test_edges_(cur, prev);
+		  }
+	    }
+      }
 }
 
 bool operator == (const udp_levels_table&a, const udp_levels_table&b)
@@ -705,6 +856,34 @@ vvp_bit4_t vvp_udp_seq_s::calculate_output(const udp_levels_table&cur,
 	    break;
       }
 
+      if (levels_table_) {
+	    unsigned long idx = udp_table_index(cur_tmp);
+	    vvp_bit4_t lev = (vvp_bit4_t) levels_table_[idx];
+	    if (lev != BIT4_Z)
+		  return lev;
+
+	      /* Only one input changes at a time, so find the
+		 position of that input and its previous value. */
+	    unsigned long edge_mask = (cur.mask0 ^ prev.mask0)
+		                    | (cur.mask1 ^ prev.mask1)
+		                    | (cur.maskx ^ prev.maskx);
+	    unsigned edge_position = 0;
+	    while ((edge_mask&1) == 0) {
+		  edge_mask >>= 1;
+		  edge_position += 1;
+	    }
+	    assert(edge_mask == 1);
+
+	    unsigned pv = 0;
+	    if (prev.mask1 & (1UL << edge_position))
+		  pv = 1;
+	    else if (prev.maskx & (1UL << edge_position))
+		  pv = 2;
+
+	    return (vvp_bit4_t) edges_table_[idx*3*port_count()
+					     + 3*edge_position + pv];
+      }
+
       vvp_bit4_t lev = test_levels_(cur_tmp);
       if (lev == BIT4_Z) {
 	    lev = test_edges_(cur_tmp, prev);
@@ -111,6 +111,16 @@ struct udp_levels_table {
 };
 extern ostream& operator<< (ostream&o, const struct udp_levels_table&t);
 
+/*
+ * UDPs with only a few inputs are also compiled into dense tables
+ * when the rows are compiled. The tables are indexed by the input
+ * values, two bits per input (0, 1 or x) with the first input in the
+ * least significant bits, so evaluating the device is a single table
+ * lookup instead of a scan of all the rows. UDPs with more inputs
+ * than the limits here fall back to scanning the rows.
+ */
+enum { UDP_COMB_TABLE_PORTS = 8, UDP_SEQ_TABLE_PORTS = 5 };
+
 class vvp_udp_comb_s : public vvp_udp_s {
 
     public:
@@ -127,6 +137,12 @@ class vvp_udp_comb_s : public vvp_udp_s {
 				  vvp_bit4_t cur_out);
 
     private:
+      vvp_bit4_t test_rows_(const udp_levels_table&cur);
+
+	// Output for each input combination, or nil if the device
+	// has too many inputs to be compiled into a table.
+      unsigned char*table_;
+
 	// Level sensitive rows of the device.
       struct udp_levels_table*levels0_;
       struct udp_levels_table*levels1_;
@@ -208,6 +224,16 @@ class vvp_udp_seq_s : public vvp_udp_s {
       struct udp_edges_table*edgesL_;
       unsigned nedges0_, nedges1_, nedgesL_;
 
+      void compile_lookup_(void);
+
+	// The levels_table_ holds the result of test_levels_ for each
+	// combination of inputs and current output. The edges_table_
+	// holds the result of test_edges_ for each of those and each
+	// single input edge, indexed by the edge position and the
+	// previous value of the input. These are nil if the device has
+	// too many inputs to be compiled into tables.
+      unsigned char*levels_table_;
+      unsigned char*edges_table_;
 };
 
 /*
@@ -230,6 +256,8 @@ class vvp_udp_fun_core  : public vvp_wide_fun_core, private vvp_gen_event_s {
 
       void recv_vec4_from_inputs(unsigned);
 
+      bool is_sequential() const { return def_->is_sequential(); }
+
     private:
       void run_run();
 
@@ -36,10 +36,32 @@
 using namespace std;
 
 __vpiDarrayVar::__vpiDarrayVar(__vpiScope*sc, const char*na, vvp_net_t*ne)
-: __vpiBaseVar(sc, na, ne)
+: __vpiBaseVar(sc, na, ne), vals_size_(0)
 {
 }
 
+/*
+ * The word handles are made when they are first needed, but a
+ * dynamic array can grow after that, so make a larger table if the
+ * array has grown. The old table is not deleted since the VPI user
+ * may still be holding handles to its words.
+ */
+void __vpiDarrayVar::make_vals_words()
+{
+      if (vals_words && vals_size_ >= get_size())
+	    return;
+
+	// The array grew, so replace the word table. A word handle is
+	// only a pointer into the table, and one taken from the old
+	// table does not survive the resize of the array anyhow.
+      if (vals_words) {
+	    delete [] (vals_words-1);
+	    vals_words = 0;
+      }
+      vals_size_ = get_size();
+      __vpiArrayBase::make_vals_words();
+}
+
 unsigned __vpiDarrayVar::get_size() const
 {
       vvp_fun_signal_object*fun = dynamic_cast<vvp_fun_signal_object*> (get_net()->fun);
@@ -211,7 +233,7 @@ void __vpiDarrayVar::put_word_value(struct __vpiArrayWord*word, p_vpi_value vp,
 
 vpiHandle __vpiDarrayVar::get_iter_index(struct __vpiArrayIterator*, int idx)
 {
-      if (vals_words == 0) make_vals_words();
+      make_vals_words();
 
       return &(vals_words[idx].as_word);
 }
@@ -270,8 +292,7 @@ vpiHandle __vpiDarrayVar::vpi_index(int index)
       if (index < 0)
 	    return 0;
 
-      if (vals_words == 0)
-	    make_vals_words();
+      make_vals_words();
 
       return &(vals_words[index].as_word);
 }
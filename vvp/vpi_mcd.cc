@@ -27,6 +27,9 @@
 # include  <cstdio>
 # include  <cstdlib>
 # include  <cstring>
+# include  <deque>
+# include  <vector>
+# include  <pthread.h>
 # include  "ivl_alloc.h"
 
 extern FILE* vpi_trace;
@@ -48,6 +51,9 @@ extern FILE* vpi_trace;
 typedef struct mcd_entry {
 	FILE *fp;
 	char *filename;
+	  // Output waiting to be passed to the writer thread.
+	char *buf;
+	size_t fill;
 } mcd_entry_s;
 static mcd_entry_s mcd_table[31];
 static mcd_entry_s *fd_table = NULL;
@@ -55,17 +61,181 @@ static unsigned fd_table_len = 0;
 
 static FILE* logfile;
 
+/*
+ * If asynchronous output is enabled, the output to the MCD files
+ * (other than the stdout/log channel) is collected in a large buffer
+ * for each file. Full buffers are passed to a background thread that
+ * writes them out. The simulation thread waits for the writer to
+ * drain the queue before it touches the FILE itself, so $fflush,
+ * $fclose and the end of the simulation see all the output in
+ * order. The FD files are handed out to the VPI as FILE pointers, so
+ * they stay synchronous but get a large stdio buffer.
+ */
+static const size_t MCD_ASYNC_BUF = 256*1024;
+static const unsigned MCD_ASYNC_MAX_PENDING = 32;
+
+struct mcd_async_job {
+      FILE*fp;
+      char*buf;
+      size_t cnt;
+};
+
+static bool mcd_async_flag = false;
+static pthread_t mcd_async_thread;
+static pthread_mutex_t mcd_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  mcd_async_work_sig = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  mcd_async_done_sig = PTHREAD_COND_INITIALIZER;
+static std::deque<mcd_async_job> mcd_async_queue;
+static std::vector<char*> mcd_async_free;
+static bool mcd_async_busy = false;
+static bool mcd_async_stop = false;
+
+static void* mcd_async_work(void*)
+{
+      pthread_mutex_lock(&mcd_async_mutex);
+      for (;;) {
+	    while (mcd_async_queue.empty() && !mcd_async_stop)
+		  pthread_cond_wait(&mcd_async_work_sig, &mcd_async_mutex);
+	    if (mcd_async_queue.empty())
+		  break;
+
+	    mcd_async_job job = mcd_async_queue.front();
+	    mcd_async_queue.pop_front();
+	    mcd_async_busy = true;
+	    pthread_mutex_unlock(&mcd_async_mutex);
+
+	    fwrite(job.buf, 1, job.cnt, job.fp);
+
+	    pthread_mutex_lock(&mcd_async_mutex);
+	    mcd_async_busy = false;
+	    mcd_async_free.push_back(job.buf);
+	    pthread_cond_broadcast(&mcd_async_done_sig);
+      }
+      pthread_mutex_unlock(&mcd_async_mutex);
+      return 0;
+}
+
+/*
+ * Pass the buffered output of an entry to the writer thread and give
+ * the entry a fresh buffer. Wait if the writer is too far behind.
+ */
+static void mcd_async_submit(mcd_entry_s*ent)
+{
+      if (ent->fill == 0)
+	    return;
+
+      pthread_mutex_lock(&mcd_async_mutex);
+      while (mcd_async_queue.size() >= MCD_ASYNC_MAX_PENDING)
+	    pthread_cond_wait(&mcd_async_done_sig, &mcd_async_mutex);
+
+      mcd_async_job job;
+      job.fp = ent->fp;
+      job.buf = ent->buf;
+      job.cnt = ent->fill;
+      mcd_async_queue.push_back(job);
+      pthread_cond_signal(&mcd_async_work_sig);
+
+      if (mcd_async_free.empty()) {
+	    ent->buf = (char*)malloc(MCD_ASYNC_BUF);
+      } else {
+	    ent->buf = mcd_async_free.back();
+	    mcd_async_free.pop_back();
+      }
+      pthread_mutex_unlock(&mcd_async_mutex);
+
+      ent->fill = 0;
+}
+
+/*
+ * Wait until the writer thread has written everything it was given.
+ */
+static void mcd_async_sync(void)
+{
+      pthread_mutex_lock(&mcd_async_mutex);
+      while (!mcd_async_queue.empty() || mcd_async_busy)
+	    pthread_cond_wait(&mcd_async_done_sig, &mcd_async_mutex);
+      pthread_mutex_unlock(&mcd_async_mutex);
+}
+
+/*
+ * Make all the output for this entry reach its FILE. After this the
+ * caller may flush or close the FILE.
+ */
+static void mcd_async_drain(mcd_entry_s*ent)
+{
+      if (ent->buf == 0)
+	    return;
+
+      mcd_async_submit(ent);
+      mcd_async_sync();
+}
+
+static void mcd_write(mcd_entry_s*ent, const char*buf, size_t cnt)
+{
+      if (ent->buf == 0) {
+	    fwrite(buf, 1, cnt, ent->fp);
+	    return;
+      }
+
+      while (cnt > 0) {
+	    size_t room = MCD_ASYNC_BUF - ent->fill;
+	    if (room > cnt) room = cnt;
+	    memcpy(ent->buf + ent->fill, buf, room);
+	    ent->fill += room;
+	    buf += room;
+	    cnt -= room;
+	    if (ent->fill == MCD_ASYNC_BUF)
+		  mcd_async_submit(ent);
+      }
+}
+
+/*
+ * Write out all the pending output and stop the writer thread. This
+ * is run when vvp exits, however that happens.
+ */
+static void mcd_async_finish(void)
+{
+      if (! mcd_async_flag)
+	    return;
+
+      for (int idx = 1 ; idx < 31 ; idx += 1) {
+	    if (mcd_table[idx].buf == 0)
+		  continue;
+	    mcd_async_submit(mcd_table + idx);
+      }
+
+      pthread_mutex_lock(&mcd_async_mutex);
+      mcd_async_stop = true;
+      pthread_cond_signal(&mcd_async_work_sig);
+      pthread_mutex_unlock(&mcd_async_mutex);
+      pthread_join(mcd_async_thread, 0);
+      mcd_async_flag = false;
+
+      for (int idx = 1 ; idx < 31 ; idx += 1) {
+	    free(mcd_table[idx].buf);
+	    mcd_table[idx].buf = 0;
+      }
+      for (size_t idx = 0 ; idx < mcd_async_free.size() ; idx += 1)
+	    free(mcd_async_free[idx]);
+      mcd_async_free.clear();
+}
+
+void vpip_mcd_async_init(void)
+{
+      if (pthread_create(&mcd_async_thread, 0, mcd_async_work, 0) != 0)
+	    return;
+
+      mcd_async_flag = true;
+      atexit(mcd_async_finish);
+}
+
 /* Initialize mcd portion of vpi.  Must be called before
  * any vpi_mcd routines can be used.
  */
 void vpip_mcd_init(FILE *log)
 {
       fd_table_len = FD_INCR;
-      fd_table = (mcd_entry_s *) malloc(fd_table_len*sizeof(mcd_entry_s));
-      for (unsigned idx = 0; idx < fd_table_len; idx += 1) {
-	    fd_table[idx].fp = NULL;
-	    fd_table[idx].filename = NULL;
-      }
+      fd_table = (mcd_entry_s *) calloc(fd_table_len, sizeof(mcd_entry_s));
 
       mcd_table[0].fp = stdout;
       mcd_table[0].filename = strdup("stdout");
@@ -83,6 +253,8 @@ void vpip_mcd_init(FILE *log)
 #ifdef CHECK_WITH_VALGRIND
 void vpi_mcd_delete(void)
 {
+      mcd_async_finish();
+
       free(mcd_table[0].filename);
       mcd_table[0].filename = NULL;
       mcd_table[0].fp = NULL;
@@ -117,10 +289,13 @@ extern "C" PLI_UINT32 vpi_mcd_close(PLI_UINT32 mcd)
 	    for(int i = 1; i < 31; i++) {
 		  if ((mcd>>i) & 1) {
 			if (mcd_table[i].fp) {
+			      mcd_async_drain(mcd_table + i);
 			      if (fclose(mcd_table[i].fp)) rc |= 1<<i;
 			      free(mcd_table[i].filename);
+			      free(mcd_table[i].buf);
 			      mcd_table[i].fp = NULL;
 			      mcd_table[i].filename = NULL;
+			      mcd_table[i].buf = NULL;
 			} else {
 			      rc |= 1<<i;
 			}
@@ -175,6 +350,10 @@ got_entry:
 	if(mcd_table[i].fp == NULL)
 		return 0;
 	mcd_table[i].filename = strdup(name);
+	if (mcd_async_flag) {
+		mcd_table[i].buf = (char*)malloc(MCD_ASYNC_BUF);
+		mcd_table[i].fill = 0;
+	}
 
 	if (vpi_trace) {
 	      fprintf(vpi_trace, "vpi_mcd_open(%s) --> 0x%08x\n",
@@ -220,7 +399,7 @@ vpi_mcd_vprintf(PLI_UINT32 mcd, const char*fmt, va_list ap)
 			  // echo to logfile
 			if (i == 0 && logfile)
 			      fputs(buf_ptr, logfile);
-			fputs(buf_ptr, mcd_table[i].fp);
+			mcd_write(mcd_table + i, buf_ptr, strlen(buf_ptr));
 		  } else {
 			rc = EOF;
 		  }
@@ -251,7 +430,7 @@ extern "C" void vpip_mcd_rawwrite(PLI_UINT32 mcd, const char*buf, size_t cnt)
 	    if (mcd_table[idx].fp == 0)
 		  continue;
 
-	    fwrite(buf, 1, cnt, mcd_table[idx].fp);
+	    mcd_write(mcd_table + idx, buf, cnt);
 	    if (idx == 0 && logfile)
 		  fwrite(buf, 1, cnt, logfile);
 
@@ -265,7 +444,10 @@ extern "C" PLI_INT32 vpi_mcd_flush(PLI_UINT32 mcd)
 	if (IS_MCD(mcd)) {
 		for(int i = 0; i < 31; i++) {
 			if((mcd>>i) & 1) {
+				if (mcd_table[i].fp == NULL) continue;
 				if (i == 0 && logfile) fflush(logfile);
+				if (mcd_table[i].buf)
+					mcd_async_drain(mcd_table + i);
 				if (fflush(mcd_table[i].fp)) rc |= 1<<i;
 			}
 		}
@@ -305,6 +487,8 @@ extern "C" PLI_INT32 vpi_fopen(const char*name, const char*mode)
       for (unsigned idx = i; idx < fd_table_len; idx += 1) {
 	    fd_table[idx].fp = NULL;
 	    fd_table[idx].filename = NULL;
+	    fd_table[idx].buf = NULL;
+	    fd_table[idx].fill = 0;
       }
 
 got_entry:
@@ -318,6 +502,10 @@ got_entry:
 #endif
       if (fd_table[i].fp == NULL) return 0;
       fd_table[i].filename = strdup(name);
+	/* The FILE is used directly by the VPI, so it can not be written
+	   by another thread. Give it a large buffer instead. */
+      if (mcd_async_flag)
+	    setvbuf(fd_table[i].fp, 0, _IOFBF, MCD_ASYNC_BUF);
       return ((1U<<31)|i);
 }
 
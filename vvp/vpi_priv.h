@@ -755,7 +755,10 @@ class __vpiDarrayVar : public __vpiBaseVar, public __vpiArrayBase {
 
     protected:
       vvp_darray*get_vvp_darray() const;
+      void make_vals_words();
       __vpiDecConst left_range_, right_range_;
+	// The size of the array when vals_words was made.
+      unsigned vals_size_;
 };
 
 extern vpiHandle vpip_make_darray_var(const char*name, vvp_net_t*net);
@@ -832,12 +835,28 @@ struct __vpiSysTaskCall : public __vpiHandle {
       unsigned file_idx;
       unsigned lineno;
       bool put_value;
+	/* The call dispatch details, resolved when the call is
+	   built. This is the value (if any) pushed to the thread
+	   stack, and whether the run time computes the function
+	   itself instead of calling into VPI. */
+      enum return_kind_t { RETURN_NONE, RETURN_VEC4, RETURN_REAL,
+			   RETURN_STR };
+      enum native_t { NATIVE_NONE, NATIVE_TIME, NATIVE_SIMTIME,
+		      NATIVE_REALTIME };
+      bool is_func;
+      return_kind_t return_kind;
+      native_t native;
+      int native_scale;
     protected:
       inline __vpiSysTaskCall()
       {
 	    vec4_stack = 0;
 	    real_stack = 0;
 	    string_stack = 0;
+	    is_func = false;
+	    return_kind = RETURN_NONE;
+	    native = NATIVE_NONE;
+	    native_scale = 0;
       }
 };
 
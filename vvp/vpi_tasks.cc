@@ -25,6 +25,7 @@
 # include  "vpi_priv.h"
 # include  "vthread.h"
 # include  "compile.h"
+# include  "schedule.h"
 # include  "config.h"
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
@@ -34,6 +35,7 @@
 # include  <cstdlib>
 # include  <cstring>
 # include  <cassert>
+# include  <cmath>
 # include  "ivl_alloc.h"
 
 using namespace std;
@@ -773,6 +775,53 @@ static void cleanup_vpi_call_args(unsigned argc, vpiHandle*argv)
 }
 #endif
 
+/*
+ * A few of the system functions from the system module are called
+ * often enough, and are simple enough, that the run time computes
+ * them itself instead of going through the VPI. This is only done
+ * for the system defined functions, and only when they have no
+ * arguments.
+ */
+static void find_native_sysfunc(__vpiSysTaskCall*obj, const char*name)
+{
+      __vpiSysTaskCall::native_t native = __vpiSysTaskCall::NATIVE_NONE;
+      __vpiSysTaskCall::return_kind_t kind = __vpiSysTaskCall::RETURN_VEC4;
+
+      if (strcmp(name, "$time") == 0 || strcmp(name, "$stime") == 0) {
+	    native = __vpiSysTaskCall::NATIVE_TIME;
+      } else if (strcmp(name, "$simtime") == 0) {
+	    native = __vpiSysTaskCall::NATIVE_SIMTIME;
+      } else if (strcmp(name, "$realtime") == 0) {
+	    native = __vpiSysTaskCall::NATIVE_REALTIME;
+	    kind = __vpiSysTaskCall::RETURN_REAL;
+      } else {
+	    return;
+      }
+
+      if (obj->return_kind != kind)
+	    return;
+
+	/* The time functions work in the units of the module that
+	   contains the call. This matches sys_func_module(). */
+      __vpiScope*mod = obj->scope;
+      while (mod->get_type_code() != vpiModule && mod->scope)
+	    mod = mod->scope;
+      if (mod->get_type_code() != vpiModule)
+	    return;
+
+      obj->native = native;
+      switch (native) {
+	  case __vpiSysTaskCall::NATIVE_TIME:
+	    obj->native_scale = mod->time_units - vpip_get_time_precision();
+	    break;
+	  case __vpiSysTaskCall::NATIVE_REALTIME:
+	    obj->native_scale = vpip_get_time_precision() - mod->time_units;
+	    break;
+	  default:
+	    break;
+      }
+}
+
 /*
  * A vpi_call is actually built up into a vpiSysTaskCall VPI object
  * that refers back to the vpiUserSystf VPI object that is the
@@ -878,9 +927,27 @@ vpiHandle vpip_build_vpi_call(const char*name, int val_code, unsigned return_wid
       obj->lineno   = (unsigned) lineno;
       obj->userdata  = 0;
       obj->put_value = false;
+      obj->is_func = defn->info.type == vpiSysFunc;
+
+      if (fnet == 0) switch (val_code) {
+	  case -vpiRealVal:
+	    obj->return_kind = __vpiSysTaskCall::RETURN_REAL;
+	    break;
+	  case -vpiVectorVal:
+	    obj->return_kind = __vpiSysTaskCall::RETURN_VEC4;
+	    break;
+	  case -vpiStringVal:
+	    obj->return_kind = __vpiSysTaskCall::RETURN_STR;
+	    break;
+	  default:
+	    break;
+      }
 
       compile_compiletf(obj);
 
+      if (argc == 0 && fnet == 0 && !defn->is_user_defn)
+	    find_native_sysfunc(obj, name);
+
       return obj;
 }
 
@@ -942,45 +1009,108 @@ void vpi_call_delete(vpiHandle item)
 
 vthread_t vpip_current_vthread;
 
+/*
+ * Make a vector return value from a 64 bit time, the same way that
+ * the sysfunc_vec4 put_value method does for a vpiTimeVal.
+ */
+static void native_vec4_value(vvp_vector4_t&val, unsigned wid,
+			      unsigned long long bits)
+{
+      val = vvp_vector4_t(wid, BIT4_0);
+      for (unsigned idx = 0 ; idx < wid && idx < 64 ; idx += 1) {
+	    if ((bits >> idx) & 1)
+		  val.set_bit(idx, BIT4_1);
+      }
+}
+
+static void execute_native_sysfunc(vthread_t thr, __vpiSysTaskCall*call)
+{
+      switch (call->native) {
+
+	  case __vpiSysTaskCall::NATIVE_TIME:
+	  case __vpiSysTaskCall::NATIVE_SIMTIME: {
+		unsigned long long now = schedule_simtime();
+		if (call->native == __vpiSysTaskCall::NATIVE_TIME) {
+		      unsigned long long scale = 1;
+		      for (int idx = 0 ; idx < call->native_scale ; idx += 1)
+			    scale *= 10;
+		      unsigned long long frac = now % scale;
+		      now /= scale;
+			/* Round to the nearest integer, which may be up. */
+		      if ((scale > 1) && (frac >= scale/2))
+			    now += 1;
+		}
+		sysfunc_vec4*func = static_cast<sysfunc_vec4*>(call);
+		vvp_vector4_t val;
+		native_vec4_value(val, func->return_value().size(), now);
+		vthread_push_vec4(thr, val);
+		break;
+	  }
+
+	  case __vpiSysTaskCall::NATIVE_REALTIME: {
+		double now = (double)schedule_simtime();
+		if (call->native_scale >= 0)
+		      now = now * pow(10.0, call->native_scale);
+		else
+		      now = now / pow(10.0, -call->native_scale);
+		vthread_push_real(thr, now);
+		break;
+	  }
+
+	  default:
+	    assert(0);
+      }
+}
+
 void vpip_execute_vpi_call(vthread_t thr, vpiHandle ref)
 {
-      vpip_current_vthread = thr;
+	/* Every call handle is built by vpip_build_vpi_call. */
+      __vpiSysTaskCall*call = static_cast<__vpiSysTaskCall*>(ref);
+
+      if (call->native != __vpiSysTaskCall::NATIVE_NONE) {
+	    execute_native_sysfunc(thr, call);
+	    return;
+      }
 
-      vpip_cur_task = dynamic_cast<__vpiSysTaskCall*>(ref);
+      vpip_current_vthread = thr;
+      vpip_cur_task = call;
 
-      if (vpip_cur_task->defn->info.calltf) {
+      if (call->defn->info.calltf) {
 	    assert(vpi_mode_flag == VPI_MODE_NONE);
 	    vpi_mode_flag = VPI_MODE_CALLTF;
-	    vpip_cur_task->put_value = false;
-	    vpip_cur_task->defn->info.calltf(vpip_cur_task->defn->info.user_data);
+	    call->put_value = false;
+	    call->defn->info.calltf(call->defn->info.user_data);
 	    vpi_mode_flag = VPI_MODE_NONE;
 	      /* If the function call did not set a value then put a
 	       * default value (0). */
-	    if (ref->get_type_code() == vpiSysFuncCall &&
-	        !vpip_cur_task->put_value) {
+	    if (call->is_func && !call->put_value) {
 		  s_vpi_value val;
 		  val.format = vpiIntVal;
 		  val.value.integer = 0;
 		  vpi_put_value(ref, &val, 0, vpiNoDelay);
 	    }
       }
-      if (vpip_cur_task->vec4_stack > 0)
-	    vthread_pop_vec4(thr, vpip_cur_task->vec4_stack);
-      if (vpip_cur_task->real_stack > 0)
-	    vthread_pop_real(thr, vpip_cur_task->real_stack);
-      if (vpip_cur_task->string_stack > 0)
-	    vthread_pop_str(thr, vpip_cur_task->string_stack);
+      if (call->vec4_stack > 0)
+	    vthread_pop_vec4(thr, call->vec4_stack);
+      if (call->real_stack > 0)
+	    vthread_pop_real(thr, call->real_stack);
+      if (call->string_stack > 0)
+	    vthread_pop_str(thr, call->string_stack);
 
 	/* If the function returns a value, then push the value
 	   to the appropriate thread stack. */
-      if (sysfunc_real*func_real = dynamic_cast<sysfunc_real*>(ref)) {
-	    vthread_push_real(thr, func_real->return_value());
-      }
-      else if (sysfunc_str*func_string = dynamic_cast<sysfunc_str*>(ref)) {
-	    vthread_push_str(thr, func_string->return_value());
-      }
-      else if (sysfunc_vec4*func_vec4 = dynamic_cast<sysfunc_vec4*>(ref)) {
-	    vthread_push_vec4(thr, func_vec4->return_value());
+      switch (call->return_kind) {
+	  case __vpiSysTaskCall::RETURN_REAL:
+	    vthread_push_real(thr, static_cast<sysfunc_real*>(call)->return_value());
+	    break;
+	  case __vpiSysTaskCall::RETURN_STR:
+	    vthread_push_str(thr, static_cast<sysfunc_str*>(call)->return_value());
+	    break;
+	  case __vpiSysTaskCall::RETURN_VEC4:
+	    vthread_push_vec4(thr, static_cast<sysfunc_vec4*>(call)->return_value());
+	    break;
+	  default:
+	    break;
       }
       vpip_cur_task = 0;
 }
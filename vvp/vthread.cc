@@ -28,9 +28,11 @@
 # include  "vvp_cobject.h"
 # include  "vvp_darray.h"
 # include  "class_type.h"
+# include  "profile.h"
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
 #endif
+# include  <algorithm>
 # include  <set>
 # include  <typeinfo>
 # include  <vector>
@@ -680,6 +682,117 @@ void vthread_delay_delete()
 	    running_thread->delay_delete = 1;
 }
 
+#ifdef VVP_OPCODE_STATS
+/*
+ * The opcode counts are kept in open hash tables. Each opcode
+ * function is given a small index the first time it is seen, and the
+ * pairs are counted by the indices of the first and second opcode. A
+ * pair is only counted within a single run of a thread, because those
+ * are the sequences that could be fused into a single opcode.
+ */
+static const unsigned OPCODE_STATS_SIZE = 1024;
+static const unsigned OPCODE_PAIRS_SIZE = 65536;
+
+struct opcode_count_s {
+      vvp_code_fun fun;
+      unsigned long count;
+};
+
+struct opcode_pair_s {
+      unsigned key;
+      unsigned long count;
+};
+
+static struct opcode_count_s opcode_counts[OPCODE_STATS_SIZE];
+static struct opcode_pair_s opcode_pairs[OPCODE_PAIRS_SIZE];
+static unsigned long opcode_pairs_lost = 0;
+
+static unsigned opcode_stats_index(vvp_code_fun fun)
+{
+      unsigned idx = ((uintptr_t)fun >> 4) % OPCODE_STATS_SIZE;
+      while (opcode_counts[idx].fun != fun) {
+	    if (opcode_counts[idx].fun == 0) {
+		  opcode_counts[idx].fun = fun;
+		  break;
+	    }
+	    idx = (idx + 1) % OPCODE_STATS_SIZE;
+      }
+      return idx;
+}
+
+static void opcode_stats_pair(unsigned prev, unsigned cur)
+{
+	/* Index 0 may be a valid opcode, so keys are offset by one,
+	   and key 0 marks an empty entry. */
+      unsigned key = (prev + 1) * (OPCODE_STATS_SIZE + 1) + cur + 1;
+      unsigned idx = (key * 2654435761U) % OPCODE_PAIRS_SIZE;
+      for (unsigned probe = 0 ; probe < OPCODE_PAIRS_SIZE ; probe += 1) {
+	    if (opcode_pairs[idx].key == key) {
+		  opcode_pairs[idx].count += 1;
+		  return;
+	    }
+	    if (opcode_pairs[idx].key == 0) {
+		  opcode_pairs[idx].key = key;
+		  opcode_pairs[idx].count = 1;
+		  return;
+	    }
+	    idx = (idx + 1) % OPCODE_PAIRS_SIZE;
+      }
+      opcode_pairs_lost += 1;
+}
+
+static bool opcode_count_cmp(const opcode_count_s*a, const opcode_count_s*b)
+{
+      return a->count > b->count;
+}
+
+static bool opcode_pair_cmp(const opcode_pair_s*a, const opcode_pair_s*b)
+{
+      return a->count > b->count;
+}
+
+void vthread_print_opcode_stats(void)
+{
+      std::vector<const opcode_count_s*> ops;
+      unsigned long total = 0;
+      for (unsigned idx = 0 ; idx < OPCODE_STATS_SIZE ; idx += 1) {
+	    if (opcode_counts[idx].fun == 0)
+		  continue;
+	    ops.push_back(opcode_counts+idx);
+	    total += opcode_counts[idx].count;
+      }
+      std::sort(ops.begin(), ops.end(), opcode_count_cmp);
+
+      vpi_mcd_printf(1, "Opcodes executed: %lu\n", total);
+      for (size_t idx = 0 ; idx < ops.size() ; idx += 1) {
+	    vpi_mcd_printf(1, "    %12lu %6.2f%%  %s\n", ops[idx]->count,
+			   total? 100.0 * ops[idx]->count / total : 0.0,
+			   opcode_mnemonic(ops[idx]->fun));
+      }
+
+      std::vector<const opcode_pair_s*> pairs;
+      for (unsigned idx = 0 ; idx < OPCODE_PAIRS_SIZE ; idx += 1) {
+	    if (opcode_pairs[idx].key != 0)
+		  pairs.push_back(opcode_pairs+idx);
+      }
+      std::sort(pairs.begin(), pairs.end(), opcode_pair_cmp);
+
+      const size_t show_pairs = 50;
+      vpi_mcd_printf(1, "Most frequent opcode pairs (of %lu):\n",
+			   (unsigned long)pairs.size());
+      for (size_t idx = 0 ; idx < pairs.size() && idx < show_pairs ; idx += 1) {
+	    unsigned prev = pairs[idx]->key / (OPCODE_STATS_SIZE + 1) - 1;
+	    unsigned cur  = pairs[idx]->key % (OPCODE_STATS_SIZE + 1) - 1;
+	    vpi_mcd_printf(1, "    %12lu  %s ; %s\n", pairs[idx]->count,
+			   opcode_mnemonic(opcode_counts[prev].fun),
+			   opcode_mnemonic(opcode_counts[cur].fun));
+      }
+      if (opcode_pairs_lost)
+	    vpi_mcd_printf(1, "    %12lu  (pairs not counted, table full)\n",
+			   opcode_pairs_lost);
+}
+#endif
+
 /*
  * This function runs each thread by fetching an instruction,
  * incrementing the PC, and executing the instruction. The thread may
@@ -695,11 +808,24 @@ void vthread_run(vthread_t thr)
 	    thr->is_scheduled = 0;
 
             running_thread = thr;
+	    if (profile_flag)
+		  profile_thread_run(thr->parent_scope);
 
+#ifdef VVP_OPCODE_STATS
+	    unsigned prev_op = OPCODE_STATS_SIZE;
+#endif
 	    for (;;) {
 		  vvp_code_t cp = thr->pc;
 		  thr->pc += 1;
 
+#ifdef VVP_OPCODE_STATS
+		  unsigned cur_op = opcode_stats_index(cp->opcode);
+		  opcode_counts[cur_op].count += 1;
+		  if (prev_op != OPCODE_STATS_SIZE)
+			opcode_stats_pair(prev_op, cur_op);
+		  prev_op = cur_op;
+#endif
+
 		    /* Run the opcode implementation. If the execution of
 		       the opcode returns false, then the thread is meant to
 		       be paused, so break out of the loop. */
@@ -708,11 +834,30 @@ void vthread_run(vthread_t thr)
 			break;
 	    }
 
+	      /* The thread is yielding, so send any stores that it
+		 deferred out to the rest of the network. */
+	    vvp_coalesce_flush();
+
 	    thr = tmp;
       }
       running_thread = 0;
 }
 
+/*
+ * This is called from the profiler's sample timer, so it only looks
+ * at the running thread.
+ */
+bool vthread_profile_point(__vpiScope*&scope, vvp_code_t&pc)
+{
+      vthread_t thr = running_thread;
+      if (thr == 0)
+	    return false;
+
+      scope = thr->parent_scope;
+      pc = thr->pc;
+      return true;
+}
+
 /*
  * The CHUNK_LINK instruction is a special next pointer for linking
  * chunks of code space. It's like a simplified %jmp.
@@ -3128,6 +3273,7 @@ bool of_FORCE_VEC4_OFF(vthread_t thr, vvp_code_t cp)
 	// ensures the unforced bits retain their current value.
       vvp_signal_value*sig = dynamic_cast<vvp_signal_value*>(net->fil);
       assert(sig);
+      vvp_coalesce_flush(net);
       sig->vec4_value(tmp);
 
       tmp.set_vec(base, value);
@@ -3309,6 +3455,9 @@ bool of_IX_GETV(vthread_t thr, vvp_code_t cp)
       }
       assert(sig);
 
+	// The index may be fed by variables with deferred stores.
+      vvp_coalesce_flush(net);
+
       vvp_vector4_t vec;
       sig->vec4_value(vec);
       bool overflow_flag;
@@ -3341,6 +3490,9 @@ bool of_IX_GETV_S(vthread_t thr, vvp_code_t cp)
       }
       assert(sig);
 
+	// The index may be fed by variables with deferred stores.
+      vvp_coalesce_flush(net);
+
       vvp_vector4_t vec;
       sig->vec4_value(vec);
       int64_t val;
@@ -3651,6 +3803,8 @@ bool of_LOAD_AR(vthread_t thr, vvp_code_t cp)
       if (thr->flags[4] == BIT4_1) {
 	    word = 0.0;
       } else {
+	    if (cp->array->nets)
+		  vvp_coalesce_flush();
 	    word = cp->array->get_word_r(adr);
       }
 
@@ -3764,6 +3918,9 @@ bool of_LOAD_REAL(vthread_t thr, vvp_code_t cp)
       __vpiHandle*tmp = cp->handle;
       t_vpi_value val;
 
+	// Real nets may be converted from deferred vector stores.
+      vvp_coalesce_flush();
+
       val.format = vpiRealVal;
       vpi_get_value(tmp, &val);
 
@@ -3819,6 +3976,12 @@ bool of_LOAD_VEC4(vthread_t thr, vvp_code_t cp)
 
       vvp_net_t*net = cp->net;
 
+	// The signal may be fed (through a net, or a %cassign/link or
+	// %force/link) by variables with deferred stores, so bring it
+	// up to date first. A variable that is only stored to is
+	// already current.
+      vvp_coalesce_flush(net);
+
 	// For the %load to work, the functor must actually be a
 	// signal functor. Only signals save their vector value.
       vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (net->fil);
@@ -3853,6 +4016,11 @@ bool of_LOAD_VEC4A(vthread_t thr, vvp_code_t cp)
 	    return true;
       }
 
+	// The word of a net array may be fed by variables with
+	// deferred stores.
+      if (cp->array->nets)
+	    vvp_coalesce_flush();
+
       vvp_vector4_t tmp (cp->array->get_word(adr));
       thr->push_vec4(tmp);
       return true;
@@ -4366,7 +4534,7 @@ bool of_NEW_COBJ(vthread_t thr, vvp_code_t cp)
       const class_type*defn = dynamic_cast<const class_type*> (cp->handle);
       assert(defn);
 
-      vvp_object_t tmp (new vvp_cobject(defn));
+      vvp_object_t tmp (new (defn) vvp_cobject(defn));
       thr->push_object(tmp);
       return true;
 }
@@ -5910,10 +6078,12 @@ bool of_STORE_VEC4(vthread_t thr, vvp_code_t cp)
       }
 
 
+      vvp_coalesce_enable = true;
       if (off==0 && val_size==(unsigned)sig_value_size)
 	    vvp_send_vec4(ptr, val, thr->wt_context);
       else
 	    vvp_send_vec4_pv(ptr, val, off, wid, sig_value_size, thr->wt_context);
+      vvp_coalesce_enable = false;
 
       thr->pop_vec4(1);
       return true;
@@ -6135,6 +6305,8 @@ bool of_TEST_NUL_PROP(vthread_t thr, vvp_code_t cp)
 
 bool of_VPI_CALL(vthread_t thr, vvp_code_t cp)
 {
+	// The system task may look at any value through VPI.
+      vvp_coalesce_flush();
       vpip_execute_vpi_call(thr, cp->handle);
 
       if (schedule_stopped()) {
@@ -75,6 +75,20 @@ extern void vthread_schedule_list(vthread_t thr);
 
 extern __vpiScope*vthread_scope(vthread_t thr);
 
+/*
+ * Get the scope and program counter of the running thread. Return
+ * false if no thread is running. This is used by the profiler.
+ */
+extern bool vthread_profile_point(__vpiScope*&scope, vvp_code_t&pc);
+
+#ifdef VVP_OPCODE_STATS
+/*
+ * Print the counts of the opcodes executed by the threads, and of
+ * the pairs of opcodes executed one after the other.
+ */
+extern void vthread_print_opcode_stats(void);
+#endif
+
 /*
  * This function returns a handle to the writable context of the currently
  * running thread. Normally the writable context is the context allocated
@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * This is a microbenchmark of the data structure kernels at the core
+ * of vvp. It is linked with the vvp object files (all but main.o) and
+ * times each kernel in isolation, across a range of vector widths,
+ * fan-out sizes or batch sizes:
+ *
+ *    vector4 copy/and/or/invert/add/mul/eeq/has_xz
+ *    vector8 resolve
+ *    vvp_net_t::send_vec4 to a fan-out of nets
+ *    slab_t alloc/free
+ *    schedule_generic insertion, and draining the queue
+ *
+ * Usage: vvp_bench [-c] [-t seconds] [-k kernel]
+ *
+ *    -c          Print the results as CSV.
+ *    -t seconds  Minimum time to run each kernel (default 0.2).
+ *    -k kernel   Only run the kernels whose name contains this text.
+ *
+ * Each kernel is run with a doubling number of iterations until the
+ * run takes at least the minimum time, and the time per iteration of
+ * that run is reported.
+ */
+
+# include  "config.h"
+# include  "vvp_net.h"
+# include  "schedule.h"
+# include  "slab.h"
+# include  "parse_misc.h"
+# include  "vpi_priv.h"
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <vector>
+# include  <sys/time.h>
+# include  <unistd.h>
+
+/*
+ * These are defined in main.cc, which is not linked into the
+ * benchmark.
+ */
+bool verbose_flag = false;
+int vpip_delay_selection = _vpiDelaySelTypical;
+
+void vpip_set_return_value(int)
+{
+}
+
+void verify_version(char*ivl_ver, char*commit)
+{
+      delete[] ivl_ver;
+      delete[] commit;
+}
+
+void set_delay_selection(const char*)
+{
+}
+
+static bool csv_flag = false;
+static double min_time = 0.2;
+static const char*kernel_filter = 0;
+
+  /* Results are folded into this so that the work is not optimized
+     away. */
+static volatile unsigned long bench_sink = 0;
+
+static double wall_time(void)
+{
+      struct timeval tv;
+      gettimeofday(&tv, 0);
+      return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+typedef void (*bench_fun_t)(unsigned param, unsigned long iters);
+
+static void report(const char*kernel, const char*pname, unsigned param,
+		   unsigned long iters, double secs)
+{
+      double ns = secs * 1e9 / iters;
+      if (csv_flag) {
+	    printf("%s,%s=%u,%lu,%.2f\n", kernel, pname, param, iters, ns);
+      } else {
+	    char ptext[32];
+	    snprintf(ptext, sizeof ptext, "%s=%u", pname, param);
+	    printf("%-22s %-14s %12lu %12.2f\n", kernel, ptext, iters, ns);
+      }
+      fflush(stdout);
+}
+
+static bool selected(const char*kernel)
+{
+      return kernel_filter == 0 || strstr(kernel, kernel_filter) != 0;
+}
+
+static void run_bench(const char*kernel, const char*pname,
+		      const unsigned*params, bench_fun_t fun)
+{
+      if (! selected(kernel))
+	    return;
+
+      for (const unsigned*param = params ; *param ; param += 1) {
+	    unsigned long iters = 1;
+	    for (;;) {
+		  double start = wall_time();
+		  fun(*param, iters);
+		  double secs = wall_time() - start;
+		  if (secs >= min_time || iters >= (1UL << 40)) {
+			report(kernel, pname, *param, iters, secs);
+			break;
+		  }
+		  iters *= 2;
+	    }
+      }
+}
+
+static const unsigned vec_widths[] = { 1, 8, 32, 64, 128, 1024, 4096, 0 };
+
+  /* Make a vector of 0 and 1 bits, in a pattern that depends on seed. */
+static vvp_vector4_t make_vec4(unsigned wid, unsigned seed)
+{
+      vvp_vector4_t res (wid, BIT4_0);
+      unsigned long state = seed * 2654435761UL + 1;
+      for (unsigned idx = 0 ; idx < wid ; idx += 1) {
+	    state = state * 6364136223846793005UL + 1442695040888963407UL;
+	    if ((state >> 33) & 1)
+		  res.set_bit(idx, BIT4_1);
+      }
+      return res;
+}
+
+static void bench_vec4_copy(unsigned wid, unsigned long iters)
+{
+      vvp_vector4_t a = make_vec4(wid, 1);
+      vvp_vector4_t b;
+      for (unsigned long idx = 0 ; idx < iters ; idx += 1) {
+	    b = a;
+	    a.set_bit(0, b.value(wid-1));
+      }
+      bench_sink += b.size();
+}
+
+static void bench_vec4_and(unsigned wid, unsigned long iters)
+{
+      vvp_vector4_t a = make_vec4(wid, 1);
+      vvp_vector4_t b = make_vec4(wid, 2);
+      for (unsigned long idx = 0 ; idx < iters ; idx += 1)
+	    a &= b;
+      bench_sink += a.value(0);
+}
+
+static void bench_vec4_or(unsigned wid, unsigned long iters)
+{
+      vvp_vector4_t a = make_vec4(wid, 1);
+      vvp_vector4_t b = make_vec4(wid, 2);
+      for (unsigned long idx = 0 ; idx < iters ; idx += 1)
+	    a |= b;
+      bench_sink += a.value(0);
+}
+
+static void bench_vec4_invert(unsigned wid, unsigned long iters)
+{
+      vvp_vector4_t a = make_vec4(wid, 1);
+      for (unsigned long idx = 0 ; idx < iters ; idx += 1)
+	    a.invert();
+      bench_sink += a.value(0);
+}
+
+static void bench_vec4_add(unsigned wid, unsigned long iters)
+{
+      vvp_vector4_t a = make_vec4(wid, 1);
+      vvp_vector4_t b = make_vec4(wid, 2);
+      for (unsigned long idx = 0 ; idx < iters ; idx += 1)
+	    a.add(b);
+      bench_sink += a.value(0);
+}
+
+static void bench_vec4_mul(unsigned wid, unsigned long iters)
+{
+      vvp_vector4_t a = make_vec4(wid, 1);
+      vvp_vector4_t b = make_vec4(wid, 2);
+      b.set_bit(0, BIT4_1);
+      for (unsigned long idx = 0 ; idx < iters ; idx += 1)
+	    a.mul(b);
+      bench_sink += a.value(0);
+}
+
+static void bench_vec4_eeq(unsigned wid, unsigned long iters)
+{
+	// Equal vectors, so that the compare looks at every word.
+      vvp_vector4_t a = make_vec4(wid, 1);
+      vvp_vector4_t b = make_vec4(wid, 1);
+      unsigned long cnt = 0;
+      for (unsigned long idx = 0 ; idx < iters ; idx += 1)
+	    cnt += a.eeq(b);
+      bench_sink += cnt;
+}
+
+static void bench_vec4_has_xz(unsigned wid, unsigned long iters)
+{
+	// No x or z bits, so that the test looks at every word.
+      vvp_vector4_t a = make_vec4(wid, 1);
+      unsigned long cnt = 0;
+      for (unsigned long idx = 0 ; idx < iters ; idx += 1)
+	    cnt += a.has_xz();
+      bench_sink += cnt;
+}
+
+static void bench_vec8_resolve(unsigned wid, unsigned long iters)
+{
+	// A strong driver against a pull driver, with some bits
+	// driven to opposite values.
+      vvp_vector8_t a (make_vec4(wid, 1), 6, 6);
+      vvp_vector8_t b (make_vec4(wid, 2), 5, 5);
+      vvp_vector8_t out;
+      for (unsigned long idx = 0 ; idx < iters ; idx += 1)
+	    out = resolve(a, b);
+      bench_sink += out.size();
+}
+
+/*
+ * The fan-out kernel sends a value from one net to a chain of nets
+ * whose functors only count what they receive.
+ */
+class bench_sink_fun : public vvp_net_fun_t {
+    public:
+      bench_sink_fun() : count(0) { }
+      void recv_vec4(vvp_net_ptr_t, const vvp_vector4_t&bit, vvp_context_t)
+      { count += bit.size(); }
+
+      unsigned long count;
+};
+
+static const unsigned fanout_sizes[] = { 1, 4, 16, 64, 256, 0 };
+
+static void bench_send_fanout(unsigned fanout, unsigned long iters)
+{
+	// vvp_net_t objects are never deleted, so make each fan-out
+	// class only once.
+      static std::vector<vvp_net_t*> sources (1024, (vvp_net_t*)0);
+      static bench_sink_fun*sink_fun = 0;
+      if (sink_fun == 0)
+	    sink_fun = new bench_sink_fun;
+
+      vvp_net_t*src = sources[fanout];
+      if (src == 0) {
+	    src = new vvp_net_t;
+	    for (unsigned idx = 0 ; idx < fanout ; idx += 1) {
+		  vvp_net_t*dst = new vvp_net_t;
+		  dst->fun = sink_fun;
+		  src->link(vvp_net_ptr_t(dst, idx % 4));
+	    }
+	    sources[fanout] = src;
+      }
+
+      vvp_vector4_t val = make_vec4(32, 3);
+      for (unsigned long idx = 0 ; idx < iters ; idx += 1)
+	    src->send_vec4(val, 0);
+      bench_sink += sink_fun->count;
+}
+
+static const unsigned slab_batches[] = { 1, 64, 4096, 0 };
+
+static slab_t<48,1024> bench_slab;
+
+static void bench_slab_alloc(unsigned batch, unsigned long iters)
+{
+      std::vector<void*> items (batch);
+      unsigned long rounds = (iters + batch - 1) / batch;
+      for (unsigned long rnd = 0 ; rnd < rounds ; rnd += 1) {
+	    for (unsigned idx = 0 ; idx < batch ; idx += 1)
+		  items[idx] = bench_slab.alloc_slab();
+	    for (unsigned idx = 0 ; idx < batch ; idx += 1)
+		  bench_slab.free_slab(items[idx]);
+      }
+      bench_sink += bench_slab.pool;
+}
+
+/*
+ * The schedule kernels insert events spread over a number of time
+ * steps. The events cannot be removed from the queue except by
+ * running the simulation, which can only be done once, so these use
+ * a fixed number of events and are not repeated. The queue is drained
+ * at the end by schedule_simulate().
+ */
+struct bench_event_s : public vvp_gen_event_s {
+      void run_run() { bench_sink += 1; }
+};
+
+static const unsigned sched_steps[] = { 1, 16, 1024, 0 };
+static const unsigned long sched_events = 1000000;
+static unsigned long sched_total = 0;
+
+static void bench_schedule_insert(void)
+{
+      if (! selected("schedule insert"))
+	    return;
+
+      for (const unsigned*steps = sched_steps ; *steps ; steps += 1) {
+	    double start = wall_time();
+	    for (unsigned long idx = 0 ; idx < sched_events ; idx += 1) {
+		  vvp_time64_t delay = (idx * 7919) % *steps + 1;
+		  schedule_generic(new bench_event_s, delay, false, false, true);
+	    }
+	    double secs = wall_time() - start;
+	    report("schedule insert", "steps", *steps, sched_events, secs);
+	    sched_total += sched_events;
+      }
+
+      double start = wall_time();
+      schedule_simulate();
+      double secs = wall_time() - start;
+      report("schedule drain", "events", sched_total, sched_total, secs);
+}
+
+int main(int argc, char*argv[])
+{
+      int opt;
+      while ((opt = getopt(argc, argv, "ck:t:")) != EOF) switch (opt) {
+	  case 'c':
+	    csv_flag = true;
+	    break;
+	  case 'k':
+	    kernel_filter = optarg;
+	    break;
+	  case 't':
+	    min_time = strtod(optarg, 0);
+	    break;
+	  default:
+	    fprintf(stderr, "Usage: %s [-c] [-t seconds] [-k kernel]\n",
+		    argv[0]);
+	    return 1;
+      }
+
+      if (csv_flag)
+	    printf("kernel,param,iterations,ns_per_op\n");
+      else
+	    printf("%-22s %-14s %12s %12s\n", "kernel", "param",
+		   "iterations", "ns/op");
+
+      run_bench("vector4 copy",    "wid", vec_widths, bench_vec4_copy);
+      run_bench("vector4 and",     "wid", vec_widths, bench_vec4_and);
+      run_bench("vector4 or",      "wid", vec_widths, bench_vec4_or);
+      run_bench("vector4 invert",  "wid", vec_widths, bench_vec4_invert);
+      run_bench("vector4 add",     "wid", vec_widths, bench_vec4_add);
+      run_bench("vector4 mul",     "wid", vec_widths, bench_vec4_mul);
+      run_bench("vector4 eeq",     "wid", vec_widths, bench_vec4_eeq);
+      run_bench("vector4 has_xz",  "wid", vec_widths, bench_vec4_has_xz);
+      run_bench("vector8 resolve", "wid", vec_widths, bench_vec8_resolve);
+      run_bench("send_vec4 fanout", "fanout", fanout_sizes, bench_send_fanout);
+      run_bench("slab alloc/free", "batch", slab_batches, bench_slab_alloc);
+      bench_schedule_insert();
+
+      return 0;
+}
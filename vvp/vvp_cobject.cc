@@ -24,8 +24,23 @@
 
 using namespace std;
 
+void* vvp_cobject::operator new(size_t size, const class_type*defn)
+{
+      return defn->object_alloc(size);
+}
+
+void vvp_cobject::operator delete(void*ptr)
+{
+      class_type::object_free(ptr);
+}
+
+void vvp_cobject::operator delete(void*ptr, const class_type*)
+{
+      class_type::object_free(ptr);
+}
+
 vvp_cobject::vvp_cobject(const class_type*defn)
-: defn_(defn), properties_(defn->instance_new())
+: defn_(defn), properties_(defn->instance_new(this))
 {
 }
 
@@ -29,9 +29,16 @@ class vvp_vector4_t;
 class vvp_cobject : public vvp_object {
 
     public:
+	// Class objects are allocated from the free list of their
+	// class_type, with the property storage in the same block.
+	// Create them with "new (defn) vvp_cobject(defn)".
       explicit vvp_cobject(const class_type*defn);
       ~vvp_cobject();
 
+      static void* operator new(size_t size, const class_type*defn);
+      static void operator delete(void*ptr);
+      static void operator delete(void*ptr, const class_type*defn);
+
       void set_vec4(size_t pid, const vvp_vector4_t&val);
       void get_vec4(size_t pid, vvp_vector4_t&val);
 
@@ -20,6 +20,8 @@
 # include  "vvp_darray.h"
 # include  <iostream>
 # include  <typeinfo>
+# include  <algorithm>
+# include  <cassert>
 
 using namespace std;
 
@@ -152,126 +154,256 @@ template class vvp_darray_atom<int16_t>;
 template class vvp_darray_atom<int32_t>;
 template class vvp_darray_atom<int64_t>;
 
-vvp_darray_vec4::~vvp_darray_vec4()
-{
-}
+/*
+ * Narrow words are given the smallest lane of 8, 16 or 32 bits that
+ * holds them. Anything wider takes whole unsigned long words.
+ */
+unsigned vvp_darray_packed::lane_width(unsigned word_wid)
+{
+      unsigned lane_wid = 8;
+      while (lane_wid < word_wid && lane_wid < BITS_PER_WORD)
+	    lane_wid *= 2;
+      if (lane_wid < word_wid)
+	    lane_wid = (word_wid + BITS_PER_WORD-1) / BITS_PER_WORD * BITS_PER_WORD;
+      return lane_wid;
+}
+
+void vvp_darray_packed::set_lane(unsigned long*abits, unsigned long*bbits,
+				 unsigned lane_wid, size_t idx,
+				 const vvp_vector4_t&value)
+{
+      const unsigned long*aval, *bval;
+      if (value.size_ <= vvp_vector4_t::BITS_PER_WORD) {
+	    aval = &value.abits_val_;
+	    bval = &value.bbits_val_;
+      } else {
+	    aval = value.abits_ptr_;
+	    bval = value.bbits_ptr_;
+      }
 
-size_t vvp_darray_vec4::get_size(void) const
-{
-      return array_.size();
-}
+      if (lane_wid < BITS_PER_WORD) {
+	    size_t wdx = idx * lane_wid / BITS_PER_WORD;
+	    unsigned sft = idx * lane_wid % BITS_PER_WORD;
+	    unsigned long mask = ((1UL << lane_wid) - 1UL) << sft;
+
+	    if (bbits == 0) {
+		  unsigned long tmp = aval[0] & ~bval[0];
+		  abits[wdx] = (abits[wdx] & ~mask) | ((tmp << sft) & mask);
+	    } else {
+		  abits[wdx] = (abits[wdx] & ~mask) | ((aval[0] << sft) & mask);
+		  bbits[wdx] = (bbits[wdx] & ~mask) | ((bval[0] << sft) & mask);
+	    }
+	    return;
+      }
 
-void vvp_darray_vec4::set_word(unsigned adr, const vvp_vector4_t&value)
-{
-      if (adr >= array_.size()) return;
-      assert(value.size() == word_wid_);
-      array_[adr] = value;
+      unsigned cnt = lane_wid / BITS_PER_WORD;
+      size_t base = idx * cnt;
+      if (bbits == 0) {
+	    for (unsigned bdx = 0 ; bdx < cnt ; bdx += 1)
+		  abits[base+bdx] = aval[bdx] & ~bval[bdx];
+      } else {
+	    for (unsigned bdx = 0 ; bdx < cnt ; bdx += 1)
+		  abits[base+bdx] = aval[bdx];
+	    for (unsigned bdx = 0 ; bdx < cnt ; bdx += 1)
+		  bbits[base+bdx] = bval[bdx];
+      }
 }
 
-void vvp_darray_vec4::get_word(unsigned adr, vvp_vector4_t&value)
+void vvp_darray_packed::get_lane(const unsigned long*abits,
+				 const unsigned long*bbits,
+				 unsigned lane_wid, size_t idx,
+				 vvp_vector4_t&value)
 {
-	/*
-	 * Return an undefined value for an out of range address or if the
-	 * value has not been written yet (has a size of zero).
-	 */
-      if ((adr >= array_.size()) || (array_[adr].size() == 0)) {
-	    value = vvp_vector4_t(word_wid_, BIT4_X);
-	    return;
+      unsigned word_wid = value.size_;
+
+      unsigned long*aval, *bval;
+      if (word_wid <= vvp_vector4_t::BITS_PER_WORD) {
+	    aval = &value.abits_val_;
+	    bval = &value.bbits_val_;
+      } else {
+	    value.unshare_();
+	    aval = value.abits_ptr_;
+	    bval = value.bbits_ptr_;
       }
-      value = array_[adr];
-      assert(value.size() == word_wid_);
-}
 
-void vvp_darray_vec4::shallow_copy(const vvp_object*obj)
-{
-      const vvp_darray_vec4*that = dynamic_cast<const vvp_darray_vec4*>(obj);
-      assert(that);
+      if (lane_wid < BITS_PER_WORD) {
+	    size_t wdx = idx * lane_wid / BITS_PER_WORD;
+	    unsigned sft = idx * lane_wid % BITS_PER_WORD;
+	    unsigned long mask = (1UL << word_wid) - 1UL;
 
-      unsigned num_items = min(array_.size(), that->array_.size());
-      for (unsigned idx = 0 ; idx < num_items ; idx += 1)
-	    array_[idx] = that->array_[idx];
+	    aval[0] = (abits[wdx] >> sft) & mask;
+	    bval[0] = bbits? (bbits[wdx] >> sft) & mask : 0;
+	    return;
+      }
+
+      unsigned cnt = (word_wid + BITS_PER_WORD-1) / BITS_PER_WORD;
+      size_t base = idx * (lane_wid / BITS_PER_WORD);
+      for (unsigned bdx = 0 ; bdx < cnt ; bdx += 1)
+	    aval[bdx] = abits[base+bdx];
+      for (unsigned bdx = 0 ; bdx < cnt ; bdx += 1)
+	    bval[bdx] = bbits? bbits[base+bdx] : 0;
 }
 
-vvp_vector4_t vvp_darray_vec4::get_bitstream(bool as_vec4)
+vvp_darray_packed::vvp_darray_packed(size_t siz, unsigned word_wid,
+				     bool four_state)
+: size_(siz), word_wid_(word_wid)
 {
-      vvp_vector4_t vec(array_.size() * word_wid_, BIT4_0);
+      lane_wid_ = lane_width(word_wid_);
 
-      unsigned adx = 0;
-      unsigned vdx = vec.size();
-      while (vdx > 0) {
-            vdx -= word_wid_;
-            for (unsigned bdx = 0; bdx < word_wid_; bdx += 1) {
-                  vvp_bit4_t bit = array_[adx].value(bdx);
-                  if (as_vec4 || (bit == BIT4_1))
-                        vec.set_bit(vdx+bdx, bit);
-            }
-            adx++;
-      }
+      size_t words = (size_*lane_wid_ + BITS_PER_WORD-1) / BITS_PER_WORD;
 
-      return vec;
+	// Four state words start out X and two state words 0.
+      if (four_state) {
+	    abits_.assign(words, -1UL);
+	    bbits_.assign(words, -1UL);
+      } else {
+	    abits_.assign(words, 0UL);
+      }
 }
 
-vvp_darray_vec2::~vvp_darray_vec2()
+vvp_darray_packed::~vvp_darray_packed()
 {
 }
 
-size_t vvp_darray_vec2::get_size(void) const
+size_t vvp_darray_packed::get_size(void) const
 {
-      return array_.size();
+      return size_;
 }
 
-void vvp_darray_vec2::set_word(unsigned adr, const vvp_vector4_t&value)
+void vvp_darray_packed::set_word(unsigned adr, const vvp_vector4_t&value)
 {
-      if (adr >= array_.size()) return;
+      if (adr >= size_) return;
       assert(value.size() == word_wid_);
-      array_[adr] = value;
+
+      set_lane(&abits_[0], bbits_.empty()? 0 : &bbits_[0], lane_wid_, adr, value);
 }
 
-void vvp_darray_vec2::get_word(unsigned adr, vvp_vector4_t&value)
+void vvp_darray_packed::get_word(unsigned adr, vvp_vector4_t&value)
 {
 	/*
-	 * Return a zero value for an out of range address or if the
-	 * value has not been written yet (has a size of zero).
+	 * Return an undefined value for an out of range address. Two
+	 * state arrays return zero.
 	 */
-      if ((adr >= array_.size()) || (array_[adr].size() == 0)) {
-	    value = vvp_vector4_t(word_wid_, BIT4_0);
+      if (adr >= size_) {
+	    value = vvp_vector4_t(word_wid_, bbits_.empty()? BIT4_0 : BIT4_X);
 	    return;
       }
-      assert(array_[adr].size() == word_wid_);
-      value.resize(word_wid_);
-      for (unsigned idx = 0; idx < word_wid_; idx += 1) {
-	    value.set_bit(idx, array_[adr].value4(idx));
-      }
+
+      vvp_vector4_t res (word_wid_, BIT4_0);
+      get_lane(&abits_[0], bbits_.empty()? 0 : &bbits_[0], lane_wid_, adr, res);
+      value = res;
 }
 
-void vvp_darray_vec2::shallow_copy(const vvp_object*obj)
+void vvp_darray_packed::shallow_copy(const vvp_object*obj)
 {
-      const vvp_darray_vec2*that = dynamic_cast<const vvp_darray_vec2*>(obj);
+      const vvp_darray_packed*that = dynamic_cast<const vvp_darray_packed*>(obj);
       assert(that);
 
-      unsigned num_items = min(array_.size(), that->array_.size());
-      for (unsigned idx = 0 ; idx < num_items ; idx += 1)
-	    array_[idx] = that->array_[idx];
+      size_t num_items = min(size_, that->size_);
+
+	// If the layouts match, copy the planes a word at a time and
+	// only finish a partially covered word item by item.
+      size_t num_copied = 0;
+      if (lane_wid_ == that->lane_wid_ && word_wid_ == that->word_wid_
+	  && bbits_.empty() == that->bbits_.empty()) {
+	    size_t words = num_items * lane_wid_ / BITS_PER_WORD;
+	    copy(that->abits_.begin(), that->abits_.begin() + words,
+		 abits_.begin());
+	    if (! bbits_.empty())
+		  copy(that->bbits_.begin(), that->bbits_.begin() + words,
+		       bbits_.begin());
+	    num_copied = words * BITS_PER_WORD / lane_wid_;
+      }
+
+      vvp_darray_packed*src = const_cast<vvp_darray_packed*>(that);
+      for (size_t idx = num_copied ; idx < num_items ; idx += 1) {
+	    vvp_vector4_t tmp;
+	    src->get_word(idx, tmp);
+	    if (tmp.size() != word_wid_)
+		  tmp = vvp_vector4_t(tmp, 0, word_wid_);
+	    set_word(idx, tmp);
+      }
 }
 
-vvp_vector4_t vvp_darray_vec2::get_bitstream(bool)
+/*
+ * OR the low wid bits of val into the plane at bit position pos. The
+ * field may straddle two words of the plane.
+ */
+static inline void or_field(unsigned long*plane, size_t pos, unsigned wid,
+			    unsigned long val)
 {
-      vvp_vector4_t vec(array_.size() * word_wid_, BIT4_0);
+      const unsigned bpw = 8*sizeof(unsigned long);
+      if (wid < bpw)
+	    val &= (1UL << wid) - 1UL;
 
-      unsigned adx = 0;
-      unsigned vdx = vec.size();
-      while (vdx > 0) {
-            vdx -= word_wid_;
-            for (unsigned bdx = 0; bdx < word_wid_; bdx += 1) {
-                  if (array_[adx].value(bdx))
-                        vec.set_bit(vdx+bdx, BIT4_1);
-            }
-            adx++;
+      size_t wdx = pos / bpw;
+      unsigned sft = pos % bpw;
+      plane[wdx] |= val << sft;
+      if (sft > 0 && sft + wid > bpw)
+	    plane[wdx+1] |= val >> (bpw - sft);
+}
+
+/*
+ * The first word of the array goes into the most significant bits of
+ * the bitstream.
+ */
+vvp_vector4_t vvp_darray_packed::get_bitstream(bool as_vec4)
+{
+      vvp_vector4_t vec(size_ * word_wid_, BIT4_0);
+      if (vec.size() == 0)
+	    return vec;
+
+      unsigned long*aval, *bval;
+      if (vec.size_ <= vvp_vector4_t::BITS_PER_WORD) {
+	    aval = &vec.abits_val_;
+	    bval = &vec.bbits_val_;
+      } else {
+	    aval = vec.abits_ptr_;
+	    bval = vec.bbits_ptr_;
+      }
+
+      bool keep_xz = as_vec4 && !bbits_.empty();
+      size_t vdx = vec.size();
+      for (size_t adx = 0 ; adx < size_ ; adx += 1) {
+	    vdx -= word_wid_;
+
+	    if (lane_wid_ < BITS_PER_WORD) {
+		  size_t wdx = adx * lane_wid_ / BITS_PER_WORD;
+		  unsigned sft = adx * lane_wid_ % BITS_PER_WORD;
+		  unsigned long abit = abits_[wdx] >> sft;
+		  unsigned long bbit = bbits_.empty()? 0 : bbits_[wdx] >> sft;
+		  if (keep_xz)
+			or_field(bval, vdx, word_wid_, bbit);
+		  else
+			abit &= ~bbit;
+		  or_field(aval, vdx, word_wid_, abit);
+		  continue;
+	    }
+
+	    size_t base = adx * (lane_wid_ / BITS_PER_WORD);
+	    for (unsigned bdx = 0 ; bdx < word_wid_ ; bdx += BITS_PER_WORD) {
+		  unsigned wid = min((unsigned)BITS_PER_WORD, word_wid_ - bdx);
+		  unsigned long abit = abits_[base + bdx/BITS_PER_WORD];
+		  unsigned long bbit = bbits_.empty()? 0 : bbits_[base + bdx/BITS_PER_WORD];
+		  if (keep_xz)
+			or_field(bval, vdx+bdx, wid, bbit);
+		  else
+			abit &= ~bbit;
+		  or_field(aval, vdx+bdx, wid, abit);
+	    }
       }
 
       return vec;
 }
 
+vvp_darray_vec4::~vvp_darray_vec4()
+{
+}
+
+vvp_darray_vec2::~vvp_darray_vec2()
+{
+}
+
 vvp_darray_object::~vvp_darray_object()
 {
 }
@@ -459,13 +591,7 @@ void vvp_queue_string::set_word(unsigned adr, const string&value)
       if (adr >= array_.size())
 	    return;
 
-      list<string>::iterator cur = array_.begin();
-      while (adr > 0) {
-	    ++ cur;
-	    adr -= 1;
-      }
-
-      *cur = value;
+      array_[adr] = value;
 }
 
 void vvp_queue_string::get_word(unsigned adr, string&value)
@@ -475,13 +601,7 @@ void vvp_queue_string::get_word(unsigned adr, string&value)
 	    return;
       }
 
-      list<string>::const_iterator cur = array_.begin();
-      while (adr > 0) {
-	    ++ cur;
-	    adr -= 1;
-      }
-
-      value = *cur;
+      value = array_[adr];
 }
 
 void vvp_queue_string::pop_back(void)
@@ -494,61 +614,140 @@ void vvp_queue_string::pop_front(void)
       array_.pop_front();
 }
 
+vvp_queue_vec4::vvp_queue_vec4()
+: word_wid_(0), lane_wid_(8), capacity_(0), head_(0), count_(0)
+{
+}
+
 vvp_queue_vec4::~vvp_queue_vec4()
 {
 }
 
 size_t vvp_queue_vec4::get_size() const
 {
-      return array_.size();
+      return count_;
 }
 
-void vvp_queue_vec4::set_word(unsigned adr, const vvp_vector4_t&value)
+void vvp_queue_vec4::resize_planes_(size_t capacity)
 {
-      if (adr >= array_.size())
-	    return;
+      const unsigned bpw = 8*sizeof(unsigned long);
+      size_t words = (capacity*lane_wid_ + bpw-1) / bpw;
+      abits_.resize(words);
+      bbits_.resize(words);
+}
 
-      list<vvp_vector4_t>::iterator cur = array_.begin();
-      while (adr > 0) {
-	    ++ cur;
-	    adr -= 1;
+/*
+ * The element width can only change while the queue is empty, so
+ * there is no stored data to convert.
+ */
+void vvp_queue_vec4::set_width_(unsigned wid)
+{
+      assert(count_ == 0);
+      word_wid_ = wid;
+
+      unsigned lane_wid = vvp_darray_packed::lane_width(wid);
+      if (lane_wid != lane_wid_) {
+	    lane_wid_ = lane_wid;
+	    resize_planes_(capacity_);
       }
+      head_ = 0;
+}
 
-      *cur = value;
+/*
+ * Double the capacity of the ring. The elements are copied so that
+ * the head of the queue is at the start of the new ring.
+ */
+void vvp_queue_vec4::grow_(void)
+{
+      size_t new_capacity = capacity_? 2*capacity_ : 16;
+
+      vector<unsigned long> abits, bbits;
+      abits.swap(abits_);
+      bbits.swap(bbits_);
+      resize_planes_(new_capacity);
+
+      vvp_vector4_t tmp (word_wid_);
+      for (size_t idx = 0 ; idx < count_ ; idx += 1) {
+	    vvp_darray_packed::get_lane(&abits[0], &bbits[0], lane_wid_,
+					slot_(idx), tmp);
+	    vvp_darray_packed::set_lane(&abits_[0], &bbits_[0], lane_wid_,
+					idx, tmp);
+      }
+
+      capacity_ = new_capacity;
+      head_ = 0;
+}
+
+void vvp_queue_vec4::set_slot_(size_t adr, const vvp_vector4_t&value)
+{
+      if (value.size() != word_wid_) {
+	    vvp_vector4_t tmp (value, 0, word_wid_);
+	    set_slot_(adr, tmp);
+	    return;
+      }
+
+      vvp_darray_packed::set_lane(&abits_[0], &bbits_[0], lane_wid_,
+				  slot_(adr), value);
+}
+
+void vvp_queue_vec4::set_word(unsigned adr, const vvp_vector4_t&value)
+{
+      if (adr >= count_)
+	    return;
+
+      set_slot_(adr, value);
 }
 
 void vvp_queue_vec4::get_word(unsigned adr, vvp_vector4_t&value)
 {
-      if (adr >= array_.size()) {
+      if (adr >= count_) {
 	    value = vvp_vector4_t();
 	    return;
       }
 
-      list<vvp_vector4_t>::const_iterator cur = array_.begin();
-      while (adr > 0) {
-	    ++ cur;
-	    adr -= 1;
-      }
+      if (value.size() != word_wid_)
+	    value = vvp_vector4_t(word_wid_);
 
-      value = *cur;
+      vvp_darray_packed::get_lane(&abits_[0], &bbits_[0], lane_wid_,
+				  slot_(adr), value);
 }
 
 void vvp_queue_vec4::push_back(const vvp_vector4_t&val)
 {
-      array_.push_back(val);
+      if (count_ == 0)
+	    set_width_(val.size());
+      if (count_ == capacity_)
+	    grow_();
+
+      count_ += 1;
+      set_slot_(count_-1, val);
 }
 
 void vvp_queue_vec4::push_front(const vvp_vector4_t&val)
 {
-      array_.push_front(val);
+      if (count_ == 0)
+	    set_width_(val.size());
+      if (count_ == capacity_)
+	    grow_();
+
+      head_ = (head_ + capacity_ - 1) & (capacity_-1);
+      count_ += 1;
+      set_slot_(0, val);
 }
 
 void vvp_queue_vec4::pop_back(void)
 {
-      array_.pop_back();
+      if (count_ == 0)
+	    return;
+
+      count_ -= 1;
 }
 
 void vvp_queue_vec4::pop_front(void)
 {
-      array_.pop_front();
+      if (count_ == 0)
+	    return;
+
+      head_ = (head_ + 1) & (capacity_-1);
+      count_ -= 1;
 }
@@ -21,7 +21,7 @@
 
 # include  "vvp_object.h"
 # include  "vvp_net.h"
-# include  <list>
+# include  <deque>
 # include  <string>
 # include  <vector>
 
@@ -66,12 +66,19 @@ template <class TYPE> class vvp_darray_atom : public vvp_darray {
       std::vector<TYPE> array_;
 };
 
-class vvp_darray_vec4 : public vvp_darray {
+/*
+ * The vec4 and vec2 dynamic arrays store their words packed into bit
+ * planes instead of as an array of vector objects. Each word takes a
+ * lane of 8, 16, 32 or a whole number of unsigned long words in each
+ * plane, so lanes never straddle a word. Four state arrays have an
+ * abits and a bbits plane (with the vvp_vector4_t encoding) and two
+ * state arrays have only the abits plane.
+ */
+class vvp_darray_packed : public vvp_darray {
 
     public:
-      inline vvp_darray_vec4(size_t siz, unsigned word_wid) :
-                             array_(siz), word_wid_(word_wid) { }
-      ~vvp_darray_vec4();
+      vvp_darray_packed(size_t siz, unsigned word_wid, bool four_state);
+      ~vvp_darray_packed();
 
       size_t get_size(void) const;
       void set_word(unsigned adr, const vvp_vector4_t&value);
@@ -79,27 +86,45 @@ class vvp_darray_vec4 : public vvp_darray {
       void shallow_copy(const vvp_object*obj);
       vvp_vector4_t get_bitstream(bool as_vec4);
 
+    public:
+	// The lane layout is also used by the vec4 queue. These
+	// return the lane width for a word width, and store or fetch
+	// the word in lane idx of the planes. The bbits plane is nil
+	// for two state words. The value fetched into must already
+	// have the word width.
+      static unsigned lane_width(unsigned word_wid);
+      static void set_lane(unsigned long*abits, unsigned long*bbits,
+			   unsigned lane_wid, size_t idx,
+			   const vvp_vector4_t&value);
+      static void get_lane(const unsigned long*abits, const unsigned long*bbits,
+			   unsigned lane_wid, size_t idx, vvp_vector4_t&value);
+
     private:
-      std::vector<vvp_vector4_t> array_;
+      enum { BITS_PER_WORD = 8*sizeof(unsigned long) };
+
+      size_t size_;
       unsigned word_wid_;
+	// Bits used by each word in each plane.
+      unsigned lane_wid_;
+      std::vector<unsigned long> abits_;
+	// This is empty for two state arrays.
+      std::vector<unsigned long> bbits_;
 };
 
-class vvp_darray_vec2 : public vvp_darray {
+class vvp_darray_vec4 : public vvp_darray_packed {
 
     public:
-      inline vvp_darray_vec2(size_t siz, unsigned word_wid) :
-                             array_(siz), word_wid_(word_wid) { }
-      ~vvp_darray_vec2();
+      inline vvp_darray_vec4(size_t siz, unsigned word_wid)
+      : vvp_darray_packed(siz, word_wid, true) { }
+      ~vvp_darray_vec4();
+};
 
-      size_t get_size(void) const;
-      void set_word(unsigned adr, const vvp_vector4_t&value);
-      void get_word(unsigned adr, vvp_vector4_t&value);
-      void shallow_copy(const vvp_object*obj);
-      vvp_vector4_t get_bitstream(bool as_vec4);
+class vvp_darray_vec2 : public vvp_darray_packed {
 
-    private:
-      std::vector<vvp_vector2_t> array_;
-      unsigned word_wid_;
+    public:
+      inline vvp_darray_vec2(size_t siz, unsigned word_wid)
+      : vvp_darray_packed(siz, word_wid, false) { }
+      ~vvp_darray_vec2();
 };
 
 class vvp_darray_real : public vvp_darray {
@@ -167,9 +192,19 @@ class vvp_queue : public vvp_darray {
       virtual void pop_front(void)=0;
 };
 
+/*
+ * The vec4 queue keeps its elements in a ring buffer so that indexed
+ * access is constant time and pushing or popping at either end is
+ * amortized constant time. The elements are not stored as
+ * vvp_vector4_t objects. Instead the ring is a pair of abits and
+ * bbits planes with the lane layout of vvp_darray_packed, so narrow
+ * elements take only 8, 16 or 32 bits of each plane. The width of the
+ * elements is taken from the first value pushed into an empty queue.
+ */
 class vvp_queue_vec4 : public vvp_queue {
 
     public:
+      vvp_queue_vec4();
       ~vvp_queue_vec4();
 
       size_t get_size(void) const;
@@ -181,7 +216,24 @@ class vvp_queue_vec4 : public vvp_queue {
       void pop_front(void);
 
     private:
-      std::list<vvp_vector4_t> array_;
+	// Return the ring slot (the lane) of the adr'th element.
+      inline size_t slot_(size_t adr) const
+      { return (head_ + adr) & (capacity_-1); }
+
+      void set_slot_(size_t adr, const vvp_vector4_t&value);
+      void set_width_(unsigned wid);
+      void resize_planes_(size_t capacity);
+      void grow_(void);
+
+      unsigned word_wid_;
+	// Bits used by each element in each plane.
+      unsigned lane_wid_;
+	// The capacity_ is always zero or a power of 2.
+      size_t capacity_;
+      size_t head_;
+      size_t count_;
+      std::vector<unsigned long> abits_;
+      std::vector<unsigned long> bbits_;
 };
 
 
@@ -199,7 +251,7 @@ class vvp_queue_string : public vvp_queue {
       void pop_front(void);
 
     private:
-      std::list<std::string> array_;
+      std::deque<std::string> array_;
 };
 
 #endif /* IVL_vvp_darray_H */
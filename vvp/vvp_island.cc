@@ -21,12 +21,15 @@
 # include  "compile.h"
 # include  "symbols.h"
 # include  "schedule.h"
+# include  "vpi_priv.h"
 # include  "config.h"
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
 #endif
 # include  <iostream>
 # include  <list>
+# include  <vector>
+# include  <algorithm>
 # include  <cassert>
 # include  <cstdlib>
 # include  <cstring>
@@ -51,6 +54,9 @@ vvp_island::vvp_island()
 {
       flagged_ = false;
       branches_ = 0;
+      count_components_ = 0;
+      count_runs_ = 0;
+      count_visits_ = 0;
       ports_ = 0;
       anodes_ = 0;
       bnodes_ = 0;
@@ -68,8 +74,19 @@ vvp_island::~vvp_island()
       }
 }
 
-void vvp_island::flag_island()
+void vvp_island::flag_port(vvp_island_port*port)
 {
+      if (port->flagged)
+	    return;
+
+      port->flagged = true;
+      flagged_ports_.push_back(port);
+}
+
+void vvp_island::flag_island(vvp_island_port*port)
+{
+      flag_port(port);
+
       if (flagged_ == true)
 	    return;
 
@@ -88,6 +105,14 @@ void vvp_island::run_run()
       run_island();
 }
 
+unsigned vvp_island::count_branches(void) const
+{
+      unsigned res = 0;
+      for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch)
+	    res += 1;
+      return res;
+}
+
 
 void vvp_island::add_port(const char*key, vvp_net_t*net)
 {
@@ -162,7 +187,7 @@ void vvp_island::compile_cleanup()
 }
 
 vvp_island_port::vvp_island_port(vvp_island*ip)
-: island_(ip)
+: flagged(false), island_(ip)
 {
 }
 
@@ -178,7 +203,7 @@ void vvp_island_port::recv_vec4(vvp_net_ptr_t, const vvp_vector4_t&bit,
 	    return;
 
       invalue = tmp;
-      island_->flag_island();
+      island_->flag_island(this);
 }
 
 void vvp_island_port::recv_vec4_pv(vvp_net_ptr_t port, const vvp_vector4_t&bit,
@@ -196,7 +221,7 @@ void vvp_island_port::recv_vec8(vvp_net_ptr_t, const vvp_vector8_t&bit)
 	    return;
 
       invalue = bit;
-      island_->flag_island();
+      island_->flag_island(this);
 }
 
 void vvp_island_port::recv_vec8_pv(vvp_net_ptr_t, const vvp_vector8_t&bit,
@@ -214,15 +239,17 @@ void vvp_island_port::recv_vec8_pv(vvp_net_ptr_t, const vvp_vector8_t&bit,
 	    }
       }
 
-      island_->flag_island();
+      island_->flag_island(this);
 }
 
 void vvp_island_port::force_flag(bool run_now)
 {
-      if (run_now)
+      if (run_now) {
+	    island_->flag_port(this);
 	    island_->run_island();
-      else
-	    island_->flag_island();
+      } else {
+	    island_->flag_island(this);
+      }
 }
 
 vvp_island_branch::~vvp_island_branch()
@@ -249,6 +276,12 @@ static symbol_map_s<vvp_island>* island_table = 0;
 static vvp_island** island_list = 0;
 static unsigned island_count = 0;
 
+/*
+* The verbose statistics report needs the islands after the list is
+* gone, so only then compile_island_cleanup() keeps a copy here.
+*/
+static vector<vvp_island*> island_report;
+
 #ifdef CHECK_WITH_VALGRIND
 void island_delete()
 {
@@ -364,6 +397,9 @@ void compile_island_cleanup(void)
 	    island_list[idx]->compile_cleanup();
       }
 
+      if (verbose_flag)
+	    island_report.assign(island_list, island_list+island_count);
+
 	// If we are not doing valgrind checking then free the list.
 #ifndef CHECK_WITH_VALGRIND
       free(island_list);
@@ -375,3 +411,47 @@ void compile_island_cleanup(void)
       delete island_table;
       island_table = 0;
 }
+
+static bool compare_island_visits(const vvp_island*a, const vvp_island*b)
+{
+      return a->count_visits() > b->count_visits();
+}
+
+/*
+ * Print the totals for all the islands, and then the details for the
+ * islands that visited the most branches.
+ */
+void island_print_statistics(void)
+{
+      if (island_report.empty())
+	    return;
+
+      unsigned long branches = 0, components = 0;
+      unsigned long runs = 0, visits = 0;
+      for (unsigned idx = 0 ; idx < island_report.size() ; idx += 1) {
+	    branches += island_report[idx]->count_branches();
+	    components += island_report[idx]->count_components();
+	    runs += island_report[idx]->count_runs();
+	    visits += island_report[idx]->count_visits();
+      }
+
+      vpi_mcd_printf(1, "Island statistics:\n");
+      vpi_mcd_printf(1, "    %8u islands, %lu branches in %lu components\n",
+		     (unsigned)island_report.size(), branches, components);
+      vpi_mcd_printf(1, "    %8lu island runs, %lu branches visited\n",
+		     runs, visits);
+
+      sort(island_report.begin(), island_report.end(), compare_island_visits);
+
+      for (unsigned idx = 0 ; idx < island_report.size() && idx < 10 ; idx += 1) {
+	    vvp_island*cur = island_report[idx];
+	    if (cur->count_runs() == 0)
+		  break;
+	    vpi_mcd_printf(1, "    %8lu runs, %lu branches visited "
+			   "(%.1f per run) in island of %u branches "
+			   "and %u components\n",
+			   cur->count_runs(), cur->count_visits(),
+			   (double)cur->count_visits() / cur->count_runs(),
+			   cur->count_branches(), cur->count_components());
+      }
+}
@@ -25,6 +25,7 @@
 # include  "symbols.h"
 # include  "schedule.h"
 # include  <list>
+# include  <vector>
 # include  <cassert>
 
 /*
@@ -67,7 +68,11 @@ class vvp_island  : private vvp_gen_event_s {
 	// the input. The island will use this to create an active
 	// event. The run_run() method will then be called by the
 	// scheduler to process whatever happened.
-      void flag_island();
+      void flag_island(vvp_island_port*port);
+
+	// Note that something happened at the port, without
+	// scheduling a run of the island.
+      void flag_port(vvp_island_port*port);
 
 	// This is the method that is called, eventually, to process
 	// whatever happened. The derived island class implements this
@@ -84,6 +89,23 @@ class vvp_island  : private vvp_gen_event_s {
 	// scanning the mesh.
       vvp_island_branch*branches_;
 
+	// The ports that were flagged since the island was last
+	// run. The derived island class clears this list (and the
+	// flagged member of the ports) as it processes the ports.
+      std::vector<vvp_island_port*> flagged_ports_;
+
+	// Statistics that the derived island class collects for the
+	// verbose report.
+      unsigned count_components_;
+      unsigned long count_runs_;
+      unsigned long count_visits_;
+
+    public:
+      unsigned count_branches(void) const;
+      unsigned count_components(void) const { return count_components_; }
+      unsigned long count_runs(void) const { return count_runs_; }
+      unsigned long count_visits(void) const { return count_visits_; }
+
     public: /* These methods are used during linking. */
 
 	// Add a port to the island. The key is added to the island
@@ -146,6 +168,8 @@ class vvp_island_port  : public vvp_net_fun_t {
       vvp_vector8_t invalue;
       vvp_vector8_t outvalue;
       vvp_vector8_t value;
+	// True if the port is in the flagged_ports_ of the island.
+      bool flagged;
 
     private:
       vvp_island*island_;
@@ -235,4 +259,9 @@ extern void island_collect_node(std::list<vvp_branch_ptr_t>&conn, vvp_branch_ptr
 extern void compile_island_base(char*label, vvp_island*use_island);
 extern vvp_island* compile_find_island(const char*island_name);
 
+/*
+ * Print the island statistics for the verbose report.
+ */
+extern void island_print_statistics(void);
+
 #endif /* IVL_vvp_island_H */
@@ -33,6 +33,7 @@
 # include  <climits>
 # include  <cmath>
 # include  <cassert>
+# include  <vector>
 #ifdef CHECK_WITH_VALGRIND
 # include  <valgrind/memcheck.h>
 # include  <map>
@@ -196,6 +197,8 @@ vvp_net_t::vvp_net_t()
 
 void vvp_net_t::link(vvp_net_ptr_t port_to_link)
 {
+      if (vvp_coalesce_watching)
+	    vvp_coalesce_relink(this);
       vvp_net_t*net = port_to_link.ptr();
       net->port[port_to_link.port()] = out_;
       out_ = port_to_link;
@@ -399,6 +402,11 @@ void vvp_net_fil_t::force_unlink(void)
       force_link_->port[2] = vvp_net_ptr_t(0,0);
 }
 
+bool vvp_net_fil_t::force_linked(void) const
+{
+      return force_link_ && force_link_->port[2].ptr();
+}
+
 /* *** BIT operations *** */
 vvp_bit4_t add_with_carry(vvp_bit4_t a, vvp_bit4_t b, vvp_bit4_t&c)
 {
@@ -563,8 +571,11 @@ void vvp_send_vec8(vvp_net_ptr_t ptr, const vvp_vector8_t&val)
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  if (profile_flag) profile_functor(cur->fun);
 		  cur->fun->recv_vec8(ptr, val);
+		  if (profile_flag) profile_functor_done();
+	    }
 
 	    ptr = next;
       }
@@ -575,8 +586,11 @@ void vvp_send_real(vvp_net_ptr_t ptr, double val, vvp_context_t context)
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  if (profile_flag) profile_functor(cur->fun);
 		  cur->fun->recv_real(ptr, val, context);
+		  if (profile_flag) profile_functor_done();
+	    }
 
 	    ptr = next;
       }
@@ -615,6 +629,11 @@ void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
       if (size_ == that.size_) {
 	    if (size_ > BITS_PER_WORD) {
 		  unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
+		  if (words >= COW_WORDS) {
+			*this = that;
+			return;
+		  }
+		  unshare_();
 		  for (unsigned idx = 0 ;  idx < words ;  idx += 1)
 			abits_ptr_[idx] = that.abits_ptr_[idx];
 		  for (unsigned idx = 0 ;  idx < words ;  idx += 1)
@@ -629,6 +648,7 @@ void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
 	/* Now we know that the sizes of this and that are definitely
 	   different. We can use that in code below. In any case, we
 	   need to copy only the smaller of the sizes. */
+      unshare_();
 
 	/* If source and destination are both short, then mask/copy
 	   the bit values. */
@@ -691,6 +711,35 @@ void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
       }
 }
 
+/*
+ * Allocate the bit arrays for a vector of cnt words. The result
+ * points to the abits, and the reference count is in the word before
+ * it. The bbits follow the abits.
+ */
+unsigned long* vvp_vector4_t::alloc_words_(unsigned cnt)
+{
+      count_vector4_allocs += 1;
+      unsigned long*buf = new unsigned long[2*cnt + 1];
+      buf[0] = 1;
+      return buf + 1;
+}
+
+/*
+ * Give this vector a private copy of its shared bit arrays.
+ */
+void vvp_vector4_t::unshare_big_()
+{
+      unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
+      unsigned long*old = abits_ptr_;
+
+      abits_ptr_ = alloc_words_(words);
+      bbits_ptr_ = abits_ptr_ + words;
+      for (unsigned idx = 0 ;  idx < 2*words ;  idx += 1)
+	    abits_ptr_[idx] = old[idx];
+
+      old[-1] -= 1;
+}
+
 /*
  * This function should ONLY BE CALLED FROM vvp_vector4_t::copy_from_,
  * as it performs part of that functions tasks.
@@ -698,7 +747,15 @@ void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
 void vvp_vector4_t::copy_from_big_(const vvp_vector4_t&that)
 {
       unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
-      abits_ptr_ = new unsigned long[2*words];
+      if (words >= COW_WORDS) {
+	    abits_ptr_ = that.abits_ptr_;
+	    bbits_ptr_ = that.bbits_ptr_;
+	    abits_ptr_[-1] += 1;
+	    count_vector4_shares += 1;
+	    return;
+      }
+
+      abits_ptr_ = alloc_words_(words);
       bbits_ptr_ = abits_ptr_ + words;
 
       for (unsigned idx = 0 ;  idx < words ;  idx += 1)
@@ -717,7 +774,7 @@ void vvp_vector4_t::copy_inverted_from_(const vvp_vector4_t&that)
       size_ = that.size_;
       if (size_ > BITS_PER_WORD) {
 	    unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
-	    abits_ptr_ = new unsigned long[2*words];
+	    abits_ptr_ = alloc_words_(words);
 	    bbits_ptr_ = abits_ptr_ + words;
 
 	    unsigned remaining = size_;
@@ -747,7 +804,7 @@ void vvp_vector4_t::allocate_words_(unsigned long inita, unsigned long initb)
 {
       if (size_ > BITS_PER_WORD) {
 	    unsigned cnt = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    abits_ptr_ = new unsigned long[2*cnt];
+	    abits_ptr_ = alloc_words_(cnt);
 	    bbits_ptr_ = abits_ptr_ + cnt;
 	    for (unsigned idx = 0 ;  idx < cnt ;  idx += 1)
 		  abits_ptr_[idx] = inita;
@@ -986,6 +1043,7 @@ void vvp_vector4_t::resize(unsigned newsize, vvp_bit4_t pad_bit)
 		    // If the word count doesn't change, then there is
 		    // no need for re-allocation so we are done now.
 		  if (newsize > size_) {
+			unshare_();
 			if (unsigned fill = size_ % BITS_PER_WORD) {
 			      abits_ptr_[cnt-1] &= ~((-1UL) << fill);
 			      bbits_ptr_[cnt-1] &= ~((-1UL) << fill);
@@ -997,7 +1055,7 @@ void vvp_vector4_t::resize(unsigned newsize, vvp_bit4_t pad_bit)
 		  return;
 	    }
 
-	    unsigned long*newbits = new unsigned long[2*newcnt];
+	    unsigned long*newbits = alloc_words_(newcnt);
 
 	    if (cnt > 1) {
 		  unsigned trans = cnt;
@@ -1009,7 +1067,7 @@ void vvp_vector4_t::resize(unsigned newsize, vvp_bit4_t pad_bit)
 		  for (unsigned idx = 0 ;  idx < trans ;  idx += 1)
 			newbits[newcnt+idx] = bbits_ptr_[idx];
 
-		  delete[]abits_ptr_;
+		  release_words_();
 
 	    } else {
 		  newbits[0] = abits_val_;
@@ -1037,7 +1095,7 @@ void vvp_vector4_t::resize(unsigned newsize, vvp_bit4_t pad_bit)
 	    if (cnt > 1) {
 		  unsigned long newvala = abits_ptr_[0];
 		  unsigned long newvalb = bbits_ptr_[0];
-		  delete[]abits_ptr_;
+		  release_words_();
 		  abits_val_ = newvala;
 		  bbits_val_ = newvalb;
 	    }
@@ -1135,6 +1193,7 @@ unsigned long* vvp_vector4_t::subarray(unsigned adr, unsigned wid, bool xz_to_0)
 void vvp_vector4_t::setarray(unsigned adr, unsigned wid, const unsigned long*val)
 {
       assert(adr+wid <= size_);
+      unshare_();
 
       const unsigned BIT2_PER_WORD = 8*sizeof(unsigned long);
 
@@ -1261,11 +1320,13 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 	    tmp = (that.abits_val_ << doff) & mask;
 	    if ((abits_ptr_[dptr] & mask) != tmp) {
 		  diff_flag = true;
+		  unshare_();
 		  abits_ptr_[dptr] = (abits_ptr_[dptr] & ~mask) | tmp;
 	    }
 	    tmp = (that.bbits_val_ << doff) & mask;
 	    if ((bbits_ptr_[dptr] & mask) != tmp) {
 		  diff_flag = true;
+		  unshare_();
 		  bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
 	    }
 
@@ -1277,11 +1338,13 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 		  tmp = (that.abits_val_ >> (that.size_-tail)) & mask;
 		  if ((abits_ptr_[dptr] & mask) != tmp) {
 			diff_flag = true;
+			unshare_();
 			abits_ptr_[dptr] = (abits_ptr_[dptr] & ~mask) | tmp;
 		  }
 		  tmp = (that.bbits_val_ >> (that.size_-tail)) & mask;
 		  if ((bbits_ptr_[dptr] & mask) != tmp) {
 			diff_flag = true;
+			unshare_();
 			bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
 		  }
 	    }
@@ -1298,10 +1361,12 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 	    while (remain >= BITS_PER_WORD) {
 		  if (abits_ptr_[dptr] != that.abits_ptr_[sptr]) {
 			diff_flag = true;
+			unshare_();
 			abits_ptr_[dptr] = that.abits_ptr_[sptr];
 		  }
 		  if (bbits_ptr_[dptr] != that.bbits_ptr_[sptr]) {
 			diff_flag = true;
+			unshare_();
 			bbits_ptr_[dptr] = that.bbits_ptr_[sptr];
 		  }
 		  dptr += 1;
@@ -1316,11 +1381,13 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 		  tmp = that.abits_ptr_[sptr] & mask;
 		  if ((abits_ptr_[dptr] & mask) != tmp) {
 			diff_flag = true;
+			unshare_();
 			abits_ptr_[dptr] = (abits_ptr_[dptr] & ~mask) | tmp;
 		  }
 		  tmp = that.bbits_ptr_[sptr] & mask;
 		  if ((bbits_ptr_[dptr] & mask) != tmp) {
 			diff_flag = true;
+			unshare_();
 			bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
 		  }
 	    }
@@ -1342,11 +1409,13 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 		  tmp = (that.abits_ptr_[sptr] << doff) & ~lmask;
 		  if ((abits_ptr_[dptr] & ~lmask) != tmp) {
 			diff_flag = true;
+			unshare_();
 			abits_ptr_[dptr] = (abits_ptr_[dptr] & lmask) | tmp;
 		  }
 		  tmp = (that.bbits_ptr_[sptr] << doff) & ~lmask;
 		  if ((bbits_ptr_[dptr] & ~lmask) != tmp) {
 			diff_flag = true;
+			unshare_();
 			bbits_ptr_[dptr] = (bbits_ptr_[dptr] & lmask) | tmp;
 		  }
 		  dptr += 1;
@@ -1354,11 +1423,13 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 		  tmp = (that.abits_ptr_[sptr] >> ndoff) & lmask;
 		  if ((abits_ptr_[dptr] & lmask) != tmp) {
 			diff_flag = true;
+			unshare_();
 			abits_ptr_[dptr] = (abits_ptr_[dptr] & ~lmask) | tmp;
 		  }
 		  tmp = (that.bbits_ptr_[sptr] >> ndoff) & lmask;
 		  if ((bbits_ptr_[dptr] & lmask) != tmp) {
 			diff_flag = true;
+			unshare_();
 			bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~lmask) | tmp;
 		  }
 
@@ -1380,11 +1451,13 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 		  tmp = (that.abits_ptr_[sptr] << doff) & mask;
 		  if ((abits_ptr_[dptr] & mask) != tmp) {
 			diff_flag = true;
+			unshare_();
 			abits_ptr_[dptr] = (abits_ptr_[dptr] & ~mask) | tmp;
 		  }
 		  tmp = (that.bbits_ptr_[sptr] << doff) & mask;
 		  if ((bbits_ptr_[dptr] & mask) != tmp) {
 			diff_flag = true;
+			unshare_();
 			bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
 		  }
 
@@ -1400,11 +1473,13 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 			tmp = (that.abits_ptr_[sptr] >> (remain-tail))&mask;
 			if ((abits_ptr_[dptr] & mask) != tmp) {
 			      diff_flag = true;
+			      unshare_();
 			      abits_ptr_[dptr] = (abits_ptr_[dptr] & ~mask) | tmp;
 			}
 			tmp = (that.bbits_ptr_[sptr] >> (remain-tail))&mask;
 			if ((bbits_ptr_[dptr] & mask) != tmp) {
 			      diff_flag = true;
+			      unshare_();
 			      bbits_ptr_[dptr] = (bbits_ptr_[dptr] & ~mask) | tmp;
 			}
 		  }
@@ -1414,6 +1489,231 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
       return diff_flag;
 }
 
+/*
+ * These are the word kernels for the wide (size_ > BITS_PER_WORD)
+ * vvp_vector4_t operations. The reductions work on blocks of
+ * KERNEL_BLOCK_WORDS words with no early exit inside a block, so that
+ * the compiler can unroll and vectorize the inner loop, and only test
+ * the accumulated result between blocks.
+ */
+static const unsigned KERNEL_BLOCK_WORDS = 8;
+
+  /* Return true if any bit is set in the first "words" words of a. */
+static bool words_any_set(const unsigned long*a, unsigned words)
+{
+      unsigned idx = 0;
+      for ( ; idx+KERNEL_BLOCK_WORDS <= words ; idx += KERNEL_BLOCK_WORDS) {
+	    unsigned long acc = 0;
+	    for (unsigned blk = 0 ; blk < KERNEL_BLOCK_WORDS ; blk += 1)
+		  acc |= a[idx+blk];
+	    if (acc)
+		  return true;
+      }
+
+      unsigned long acc = 0;
+      for ( ; idx < words ; idx += 1)
+	    acc |= a[idx];
+      return acc != 0;
+}
+
+  /* Return true if any bit is set in the first "words" words of a or b. */
+static bool words_any_set(const unsigned long*a, const unsigned long*b,
+			  unsigned words)
+{
+      unsigned idx = 0;
+      for ( ; idx+KERNEL_BLOCK_WORDS <= words ; idx += KERNEL_BLOCK_WORDS) {
+	    unsigned long acc = 0;
+	    for (unsigned blk = 0 ; blk < KERNEL_BLOCK_WORDS ; blk += 1)
+		  acc |= a[idx+blk] | b[idx+blk];
+	    if (acc)
+		  return true;
+      }
+
+      unsigned long acc = 0;
+      for ( ; idx < words ; idx += 1)
+	    acc |= a[idx] | b[idx];
+      return acc != 0;
+}
+
+  /* Compare the a/b planes (la,lb) against (ra,rb) word for word. If
+     xz_as_one is true, compare the way eq_xz does, where the abits
+     of X/Z bits are ignored. */
+static bool words_equal(const unsigned long*la, const unsigned long*lb,
+			const unsigned long*ra, const unsigned long*rb,
+			unsigned words, bool xz_as_one)
+{
+      unsigned idx = 0;
+      if (xz_as_one) {
+	    for ( ; idx+KERNEL_BLOCK_WORDS <= words ; idx += KERNEL_BLOCK_WORDS) {
+		  unsigned long acc = 0;
+		  for (unsigned blk = 0 ; blk < KERNEL_BLOCK_WORDS ; blk += 1) {
+			unsigned jdx = idx+blk;
+			acc |= ((la[jdx]|lb[jdx]) ^ (ra[jdx]|rb[jdx]))
+			      | (lb[jdx] ^ rb[jdx]);
+		  }
+		  if (acc)
+			return false;
+	    }
+
+	    unsigned long acc = 0;
+	    for ( ; idx < words ; idx += 1)
+		  acc |= ((la[idx]|lb[idx]) ^ (ra[idx]|rb[idx]))
+			| (lb[idx] ^ rb[idx]);
+	    return acc == 0;
+      }
+
+      for ( ; idx+KERNEL_BLOCK_WORDS <= words ; idx += KERNEL_BLOCK_WORDS) {
+	    unsigned long acc = 0;
+	    for (unsigned blk = 0 ; blk < KERNEL_BLOCK_WORDS ; blk += 1) {
+		  unsigned jdx = idx+blk;
+		  acc |= (la[jdx] ^ ra[jdx]) | (lb[jdx] ^ rb[jdx]);
+	    }
+	    if (acc)
+		  return false;
+      }
+
+      unsigned long acc = 0;
+      for ( ; idx < words ; idx += 1)
+	    acc |= (la[idx] ^ ra[idx]) | (lb[idx] ^ rb[idx]);
+      return acc == 0;
+}
+
+/*
+ * Multiplication of wide vectors. The schoolbook method is used for
+ * operands narrower than KARATSUBA_WORDS words, and above that the
+ * operands are split in half and the Karatsuba method is used for the
+ * full sub-products. Only the low words of the product are kept by
+ * vvp_vector4_t::mul, so mul_words_low skips the partial products that
+ * would land above the result.
+ */
+static const unsigned KARATSUBA_WORDS = 24;
+
+  /* res[0..nres) = low nres words of a[0..na) * b[0..nb) */
+static void mul_words_school(unsigned long*res, const unsigned long*a,
+			     unsigned na, const unsigned long*b, unsigned nb,
+			     unsigned nres)
+{
+      for (unsigned idx = 0 ; idx < nres ; idx += 1)
+	    res[idx] = 0;
+
+      for (unsigned adx = 0 ; adx < na && adx < nres ; adx += 1) {
+	    unsigned long lval = a[adx];
+	    if (lval == 0)
+		  continue;
+
+	    unsigned long carry = 0;
+	    unsigned bdx = 0;
+	    for ( ; bdx < nb && adx+bdx < nres ; bdx += 1) {
+		    // The high word of lval*rval + res + carry can
+		    // not overflow, so hi collects both carries.
+		  unsigned long hi;
+		  unsigned long lo = multiply_with_carry(lval, b[bdx], hi);
+		  unsigned long tmp = res[adx+bdx] + lo;
+		  hi += tmp < lo;
+		  tmp += carry;
+		  hi += tmp < carry;
+		  res[adx+bdx] = tmp;
+		  carry = hi;
+	    }
+	    if (adx+bdx < nres)
+		  res[adx+bdx] = carry;
+      }
+}
+
+  /* Add src[0..nsrc) into dst[0..ndst) and return the carry out. */
+static unsigned long add_words(unsigned long*dst, unsigned ndst,
+			       const unsigned long*src, unsigned nsrc)
+{
+      unsigned long carry = 0;
+      unsigned idx = 0;
+      for ( ; idx < nsrc && idx < ndst ; idx += 1)
+	    dst[idx] = add_with_carry(dst[idx], src[idx], carry);
+      for ( ; carry && idx < ndst ; idx += 1)
+	    dst[idx] = add_with_carry(dst[idx], 0, carry);
+      return carry;
+}
+
+  /* Subtract src[0..nsrc) from dst[0..ndst), ignoring the borrow out. */
+static void sub_words(unsigned long*dst, unsigned ndst,
+		      const unsigned long*src, unsigned nsrc)
+{
+      unsigned long carry = 1;
+      for (unsigned idx = 0 ; idx < ndst ; idx += 1)
+	    dst[idx] = add_with_carry(dst[idx], idx < nsrc? ~src[idx] : ~0UL, carry);
+}
+
+  /* res[0..2n) = a[0..n) * b[0..n) */
+static void mul_words_full(unsigned long*res, const unsigned long*a,
+			   const unsigned long*b, unsigned n)
+{
+      if (n < KARATSUBA_WORDS) {
+	    mul_words_school(res, a, n, b, n, 2*n);
+	    return;
+      }
+
+      unsigned lo = n / 2;
+      unsigned hi = n - lo;
+
+	// z0 = a0*b0 goes into res[0..2lo), and z2 = a1*b1 goes into
+	// res[2lo..2n). They do not overlap.
+      mul_words_full(res, a, b, lo);
+      mul_words_full(res+2*lo, a+lo, b+lo, hi);
+
+	// z1 = (a0+a1)*(b0+b1) - z0 - z2
+      vector<unsigned long> work (4*(hi+1));
+      unsigned long*sa = &work[0];
+      unsigned long*sb = sa + hi + 1;
+      unsigned long*z1 = sb + hi + 1;
+      for (unsigned idx = 0 ; idx < hi ; idx += 1) {
+	    sa[idx] = a[lo+idx];
+	    sb[idx] = b[lo+idx];
+      }
+      sa[hi] = add_words(sa, hi, a, lo);
+      sb[hi] = add_words(sb, hi, b, lo);
+
+      mul_words_full(z1, sa, sb, hi+1);
+      sub_words(z1, 2*hi+2, res, 2*lo);
+      sub_words(z1, 2*hi+2, res+2*lo, 2*hi);
+
+      add_words(res+lo, 2*n-lo, z1, 2*hi+2);
+}
+
+  /* res[0..n) = low n words of a[0..n) * b[0..n) */
+static void mul_words_low(unsigned long*res, const unsigned long*a,
+			  const unsigned long*b, unsigned n)
+{
+      if (n < KARATSUBA_WORDS) {
+	    mul_words_school(res, a, n, b, n, n);
+	    return;
+      }
+
+      unsigned lo = n / 2;
+      unsigned hi = n - lo;
+
+	// The a0*b0 product fits entirely in the result. Of a1*b1,
+	// only the low word of a[lo]*b[lo] lands in the result, and
+	// only if n is odd.
+      mul_words_full(res, a, b, lo);
+      if (2*lo < n)
+	    res[2*lo] = a[lo] * b[lo];
+
+	// Only the low hi words of the cross products a1*b0 and
+	// a0*b1 land in the result.
+      vector<unsigned long> work (3*hi, 0);
+      unsigned long*a0 = &work[0];
+      unsigned long*b0 = a0 + hi;
+      unsigned long*tmp = b0 + hi;
+      for (unsigned idx = 0 ; idx < lo ; idx += 1) {
+	    a0[idx] = a[idx];
+	    b0[idx] = b[idx];
+      }
+
+      mul_words_low(tmp, a+lo, b0, hi);
+      add_words(res+lo, hi, tmp, hi);
+      mul_words_low(tmp, a0, b+lo, hi);
+      add_words(res+lo, hi, tmp, hi);
+}
+
 /*
  * Add that vector to this vector. Do it in the Verilog way, which
  * means if we detect any X or Z bits, change the entire results to
@@ -1424,6 +1724,7 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
 void vvp_vector4_t::add(const vvp_vector4_t&that)
 {
       assert(size_ == that.size_);
+      unshare_();
 
       if (size_ < BITS_PER_WORD) {
 	    unsigned long mask = ~(-1UL << size_);
@@ -1449,19 +1750,21 @@ void vvp_vector4_t::add(const vvp_vector4_t&that)
       }
 
       int cnt = size_ / BITS_PER_WORD;
+      unsigned tail = size_ % BITS_PER_WORD;
       unsigned long carry = 0;
-      for (int idx = 0 ; idx < cnt ; idx += 1) {
-	    if (bbits_ptr_[idx] | that.bbits_ptr_[idx])
-		  goto x_out;
 
+	// Check all the XZ bits in one pass before doing any of the
+	// arithmetic, so that the carry loop has no exits.
+      if (words_any_set(bbits_ptr_, that.bbits_ptr_, cnt))
+	    goto x_out;
+      if (tail && ((bbits_ptr_[cnt] | that.bbits_ptr_[cnt]) & ~(-1UL << tail)))
+	    goto x_out;
+
+      for (int idx = 0 ; idx < cnt ; idx += 1)
 	    abits_ptr_[idx] = add_with_carry(abits_ptr_[idx], that.abits_ptr_[idx], carry);
-      }
 
-      if (unsigned tail = size_ % BITS_PER_WORD) {
+      if (tail) {
 	    unsigned long mask = ~( -1UL << tail );
-	    if ((bbits_ptr_[cnt] | that.bbits_ptr_[cnt])&mask)
-		  goto x_out;
-
 	    abits_ptr_[cnt] = add_with_carry(abits_ptr_[cnt], that.abits_ptr_[cnt], carry);
 	    abits_ptr_[cnt] &= mask;
       }
@@ -1473,7 +1776,7 @@ void vvp_vector4_t::add(const vvp_vector4_t&that)
 	    abits_ptr_[idx] = WORD_X_ABITS;
 	    bbits_ptr_[idx] = WORD_X_BBITS;
       }
-      if (unsigned tail = size_%BITS_PER_WORD) {
+      if (tail) {
 	    unsigned long mask = ~( -1UL << tail );
 	    abits_ptr_[cnt] = WORD_X_ABITS&mask;
 	    bbits_ptr_[cnt] = WORD_X_BBITS&mask;
@@ -1483,6 +1786,7 @@ void vvp_vector4_t::add(const vvp_vector4_t&that)
 void vvp_vector4_t::sub(const vvp_vector4_t&that)
 {
       assert(size_ == that.size_);
+      unshare_();
 
       if (size_ < BITS_PER_WORD) {
 	    unsigned long mask = ~(-1UL << size_);
@@ -1508,19 +1812,21 @@ void vvp_vector4_t::sub(const vvp_vector4_t&that)
       }
 
       int cnt = size_ / BITS_PER_WORD;
+      unsigned tail = size_ % BITS_PER_WORD;
       unsigned long carry = 1;
-      for (int idx = 0 ; idx < cnt ; idx += 1) {
-	    if (bbits_ptr_[idx] | that.bbits_ptr_[idx])
-		  goto x_out;
 
+	// Check all the XZ bits in one pass before doing any of the
+	// arithmetic, so that the carry loop has no exits.
+      if (words_any_set(bbits_ptr_, that.bbits_ptr_, cnt))
+	    goto x_out;
+      if (tail && ((bbits_ptr_[cnt] | that.bbits_ptr_[cnt]) & ~(-1UL << tail)))
+	    goto x_out;
+
+      for (int idx = 0 ; idx < cnt ; idx += 1)
 	    abits_ptr_[idx] = add_with_carry(abits_ptr_[idx], ~that.abits_ptr_[idx], carry);
-      }
 
-      if (unsigned tail = size_ % BITS_PER_WORD) {
+      if (tail) {
 	    unsigned long mask = ~( -1UL << tail );
-	    if ((bbits_ptr_[cnt] | that.bbits_ptr_[cnt])&mask)
-		  goto x_out;
-
 	    abits_ptr_[cnt] = add_with_carry(abits_ptr_[cnt], ~that.abits_ptr_[cnt], carry);
 	    abits_ptr_[cnt] &= mask;
       }
@@ -1532,7 +1838,7 @@ void vvp_vector4_t::sub(const vvp_vector4_t&that)
 	    abits_ptr_[idx] = WORD_X_ABITS;
 	    bbits_ptr_[idx] = WORD_X_BBITS;
       }
-      if (unsigned tail = size_%BITS_PER_WORD) {
+      if (tail) {
 	    unsigned long mask = ~( -1UL << tail );
 	    abits_ptr_[cnt] = WORD_X_ABITS&mask;
 	    bbits_ptr_[cnt] = WORD_X_BBITS&mask;
@@ -1544,6 +1850,7 @@ void vvp_vector4_t::mov(unsigned dst, unsigned src, unsigned cnt)
 {
       assert(dst+cnt <= size_);
       assert(src+cnt <= size_);
+      unshare_();
 
       if (size_ <= BITS_PER_WORD) {
 	    unsigned long vmask = (1UL << cnt) - 1;
@@ -1616,6 +1923,7 @@ void vvp_vector4_t::mov(unsigned dst, unsigned src, unsigned cnt)
 void vvp_vector4_t::mul(const vvp_vector4_t&that)
 {
       assert(size_ == that.size_);
+      unshare_();
 
       if (size_ < BITS_PER_WORD) {
 	    unsigned long mask = ~(-1UL << size_);
@@ -1652,63 +1960,39 @@ void vvp_vector4_t::mul(const vvp_vector4_t&that)
 	// Check for any XZ values ahead of time in a first pass. If
 	// we find any, then force the entire result to be X and be
 	// done.
-      for (int idx = 0 ; idx < cnt ; idx += 1) {
-	    unsigned long lval = bbits_ptr_[idx];
-	    unsigned long rval = that.bbits_ptr_[idx];
-	    if (idx == (cnt-1)) {
-		  lval &= mask;
-		  rval &= mask;
-	    }
-	    if (lval || rval) {
-		  for (int xdx = 0 ; xdx < cnt-1 ; xdx += 1) {
-			abits_ptr_[xdx] = WORD_X_ABITS;
-			bbits_ptr_[xdx] = WORD_X_BBITS;
-		  }
-		  abits_ptr_[cnt-1] = WORD_X_ABITS & mask;
-		  bbits_ptr_[cnt-1] = WORD_X_BBITS & mask;
-		  return;
-	    }
+      if (words_any_set(bbits_ptr_, that.bbits_ptr_, cnt-1)
+	  || ((bbits_ptr_[cnt-1] | that.bbits_ptr_[cnt-1]) & mask)) {
+	    for (int xdx = 0 ; xdx < cnt-1 ; xdx += 1) {
+		  abits_ptr_[xdx] = WORD_X_ABITS;
+		  bbits_ptr_[xdx] = WORD_X_BBITS;
+	    }
+	    abits_ptr_[cnt-1] = WORD_X_ABITS & mask;
+	    bbits_ptr_[cnt-1] = WORD_X_BBITS & mask;
+	    return;
       }
 
-	// Calculate the result into a res array. We need to keep is
-	// separate from the "this" array because we are making
-	// multiple passes.
-      unsigned long*res = new unsigned long[cnt];
-      for (int idx = 0 ; idx < cnt ; idx += 1)
-	    res[idx] = 0;
-
-      for (int mul_a = 0 ; mul_a < cnt ; mul_a += 1) {
-	    unsigned long lval = abits_ptr_[mul_a];
-	    if (mul_a == (cnt-1))
-		  lval &= mask;
-
-	    for (int mul_b = 0 ; mul_b < (cnt-mul_a) ; mul_b += 1) {
-		  unsigned long rval = that.abits_ptr_[mul_b];
-		  if (mul_b == (cnt-1))
-			rval &= mask;
-
-		  unsigned long sum;
-		  unsigned long tmp = multiply_with_carry(lval, rval, sum);
-		  int base = mul_a + mul_b;
-		  unsigned long carry = 0;
-		  res[base] = add_with_carry(res[base], tmp, carry);
-		  for (int add_idx = base+1 ; add_idx < cnt ; add_idx += 1) {
-			res[add_idx] = add_with_carry(res[add_idx], sum, carry);
-			sum = 0;
-		  }
-	    }
+	// Calculate the result into a res array. The operands are
+	// copied with the unused bits of the top word cleared, and
+	// the result is kept separate from the "this" array because
+	// the kernel reads the operands more than once.
+      vector<unsigned long> work (3*cnt);
+      unsigned long*lval = &work[0];
+      unsigned long*rval = lval + cnt;
+      unsigned long*res = rval + cnt;
+      for (int idx = 0 ; idx < cnt ; idx += 1) {
+	    lval[idx] = abits_ptr_[idx];
+	    rval[idx] = that.abits_ptr_[idx];
       }
+      lval[cnt-1] &= mask;
+      rval[cnt-1] &= mask;
+
+      mul_words_low(res, lval, rval, cnt);
 
 	// Replace the "this" value with the calculated result. We
 	// know a-priori that the bbits are zero and unchanged.
       res[cnt-1] &= mask;
       for (int idx = 0 ; idx < cnt ; idx += 1)
 	    abits_ptr_[idx] = res[idx];
-
-      delete[]res;
-      return;
-
-
 }
 
 bool vvp_vector4_t::eeq(const vvp_vector4_t&that) const
@@ -1728,12 +2012,9 @@ bool vvp_vector4_t::eeq(const vvp_vector4_t&that) const
       }
 
       unsigned words = size_ / BITS_PER_WORD;
-      for (unsigned idx = 0 ;  idx < words ;  idx += 1) {
-	    if (abits_ptr_[idx] != that.abits_ptr_[idx])
-		  return false;
-	    if (bbits_ptr_[idx] != that.bbits_ptr_[idx])
-		  return false;
-      }
+      if (! words_equal(abits_ptr_, bbits_ptr_,
+			that.abits_ptr_, that.bbits_ptr_, words, false))
+	    return false;
 
       unsigned long mask = size_%BITS_PER_WORD;
       if (mask > 0) {
@@ -1762,12 +2043,9 @@ bool vvp_vector4_t::eq_xz(const vvp_vector4_t&that) const
       }
 
       unsigned words = size_ / BITS_PER_WORD;
-      for (unsigned idx = 0 ;  idx < words ;  idx += 1) {
-	    if ((abits_ptr_[idx]|bbits_ptr_[idx]) != (that.abits_ptr_[idx]|that.bbits_ptr_[idx]))
-		  return false;
-	    if (bbits_ptr_[idx] != that.bbits_ptr_[idx])
-		  return false;
-      }
+      if (! words_equal(abits_ptr_, bbits_ptr_,
+			that.abits_ptr_, that.bbits_ptr_, words, true))
+	    return false;
 
       unsigned long mask = size_%BITS_PER_WORD;
       if (mask > 0) {
@@ -1791,10 +2069,8 @@ bool vvp_vector4_t::has_xz() const
       }
 
       unsigned words = size_ / BITS_PER_WORD;
-      for (unsigned idx = 0 ; idx < words ; idx += 1) {
-	    if (bbits_ptr_[idx])
-		  return true;
-      }
+      if (words_any_set(bbits_ptr_, words))
+	    return true;
 
       unsigned long mask = size_%BITS_PER_WORD;
       if (mask > 0) {
@@ -1807,6 +2083,8 @@ bool vvp_vector4_t::has_xz() const
 
 void vvp_vector4_t::change_z2x()
 {
+      unshare_();
+
 	// This method relies on the fact that both BIT4_X and BIT4_Z
 	// have the bbit set in the vector4 encoding, and also that
 	// the BIT4_X has abit set in the vector4 encoding. By simply
@@ -1824,6 +2102,7 @@ void vvp_vector4_t::change_z2x()
 
 void vvp_vector4_t::set_to_x()
 {
+      unshare_();
       if (size_ <= BITS_PER_WORD) {
 	    abits_val_ = vvp_vector4_t::WORD_X_ABITS;
             bbits_val_ = vvp_vector4_t::WORD_X_BBITS;
@@ -1868,29 +2147,29 @@ char* vvp_vector4_t::as_string(char*buf, size_t buf_len) const
 
 void vvp_vector4_t::invert()
 {
+      unshare_();
       if (size_ <= BITS_PER_WORD) {
 	    unsigned long mask = (size_<BITS_PER_WORD)? (1UL<<size_)-1UL : -1UL;
 	    abits_val_ = mask & ~abits_val_;
 	    abits_val_ |= bbits_val_;
       } else {
-	    unsigned remaining = size_;
-	    unsigned idx = 0;
-	    while (remaining >= BITS_PER_WORD) {
-		  abits_ptr_[idx] = ~abits_ptr_[idx];
-		  abits_ptr_[idx] |= bbits_ptr_[idx];
-		  idx += 1;
-		  remaining -= BITS_PER_WORD;
-	    }
-	    if (remaining > 0) {
+	    unsigned words = size_ / BITS_PER_WORD;
+	    unsigned long*ap = abits_ptr_;
+	    const unsigned long*bp = bbits_ptr_;
+	    for (unsigned idx = 0 ; idx < words ; idx += 1)
+		  ap[idx] = ~ap[idx] | bp[idx];
+
+	    if (unsigned remaining = size_ % BITS_PER_WORD) {
 		  unsigned long mask = (1UL<<remaining) - 1UL;
-		  abits_ptr_[idx] = mask & ~abits_ptr_[idx];
-		  abits_ptr_[idx] |= bbits_ptr_[idx];
+		  ap[words] = (mask & ~ap[words]) | bp[words];
 	    }
       }
 }
 
 vvp_vector4_t& vvp_vector4_t::operator &= (const vvp_vector4_t&that)
 {
+      unshare_();
+
 	// The truth table is:
 	//     00 01 11 10
 	//  00 00 00 00 00
@@ -1904,13 +2183,18 @@ vvp_vector4_t& vvp_vector4_t::operator &= (const vvp_vector4_t&that)
 	    bbits_val_ = (tmp1 & that.bbits_val_) | (tmp2 & bbits_val_);
       } else {
 	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	      // Work through local copies of the plane pointers so that
+	      // the compiler need not reload them after every store.
+	    unsigned long*ap = abits_ptr_;
+	    unsigned long*bp = bbits_ptr_;
+	    const unsigned long*tap = that.abits_ptr_;
+	    const unsigned long*tbp = that.bbits_ptr_;
 	    for (unsigned idx = 0; idx < words ; idx += 1) {
-		  unsigned long tmp1 = abits_ptr_[idx] | bbits_ptr_[idx];
-		  unsigned long tmp2 = that.abits_ptr_[idx] |
-		                       that.bbits_ptr_[idx];
-		  abits_ptr_[idx] = tmp1 & tmp2;
-		  bbits_ptr_[idx] = (tmp1 & that.bbits_ptr_[idx]) |
-		                    (tmp2 & bbits_ptr_[idx]);
+		  unsigned long tmp1 = ap[idx] | bp[idx];
+		  unsigned long tmp2 = tap[idx] | tbp[idx];
+		  unsigned long bval = (tmp1 & tbp[idx]) | (tmp2 & bp[idx]);
+		  ap[idx] = tmp1 & tmp2;
+		  bp[idx] = bval;
 	    }
       }
 
@@ -1919,6 +2203,8 @@ vvp_vector4_t& vvp_vector4_t::operator &= (const vvp_vector4_t&that)
 
 vvp_vector4_t& vvp_vector4_t::operator |= (const vvp_vector4_t&that)
 {
+      unshare_();
+
 	// The truth table is:
 	//     00 01 11 10
 	//  00 00 01 11 11
@@ -1934,14 +2220,15 @@ vvp_vector4_t& vvp_vector4_t::operator |= (const vvp_vector4_t&that)
 
       } else {
 	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	    unsigned long*ap = abits_ptr_;
+	    unsigned long*bp = bbits_ptr_;
+	    const unsigned long*tap = that.abits_ptr_;
+	    const unsigned long*tbp = that.bbits_ptr_;
 	    for (unsigned idx = 0; idx < words ; idx += 1) {
-		  unsigned long tmp = abits_ptr_[idx] | bbits_ptr_[idx] |
-	                        that.abits_ptr_[idx] | that.bbits_ptr_[idx];
-		  bbits_ptr_[idx] = ((~abits_ptr_[idx] | bbits_ptr_[idx]) &
-		                     that.bbits_ptr_[idx]) |
-		                    ((~that.abits_ptr_[idx] |
-		                      that.bbits_ptr_[idx]) & bbits_ptr_[idx]);
-		  abits_ptr_[idx] = tmp;
+		  unsigned long tmp = ap[idx] | bp[idx] | tap[idx] | tbp[idx];
+		  bp[idx] = ((~ap[idx] | bp[idx]) & tbp[idx]) |
+		            ((~tap[idx] | tbp[idx]) & bp[idx]);
+		  ap[idx] = tmp;
 	    }
       }
 
@@ -24,6 +24,7 @@
 # include  "vvp_vpi_callback.h"
 # include  "permaheap.h"
 # include  "vvp_object.h"
+# include  "profile.h"
 # include  <cstddef>
 # include  <cstdlib>
 # include  <cstring>
@@ -247,6 +248,7 @@ class vvp_vector4_t {
       friend class vvp_vector4array_t;
       friend class vvp_vector4array_sa;
       friend class vvp_vector4array_aa;
+      friend class vvp_darray_packed;
 
     public:
       static const vvp_vector4_t nil;
@@ -357,6 +359,18 @@ class vvp_vector4_t {
 
       void allocate_words_(unsigned long inita, unsigned long initb);
 
+	// The bit arrays of multi-word vectors carry a reference
+	// count in the word just before the abits. Vectors of at
+	// least COW_WORDS words share the arrays between copies, and
+	// every method that writes the bits calls unshare_ first to
+	// get a private copy (copy-on-write). Narrower vectors are
+	// cheaper to copy than to share.
+      enum { COW_WORDS = 4 };
+      static unsigned long*alloc_words_(unsigned cnt);
+      void release_words_();
+      void unshare_();
+      void unshare_big_();
+
 	// Values in the vvp_vector4_t are stored split across two
 	// arrays. For each bit in the vector, there is an abit and a
 	// bbit. the encoding of a vvp_vector4_t is:
@@ -410,13 +424,24 @@ inline vvp_vector4_t::vvp_vector4_t(unsigned size__, vvp_bit4_t val)
       allocate_words_(init_atable[val], init_btable[val]);
 }
 
+inline void vvp_vector4_t::release_words_()
+{
+	// bbits_ptr_ actually points half-way into a double-length
+	// array started at abits_ptr_, which is in turn one word past
+	// the start of the allocated array.
+      if (size_ > BITS_PER_WORD && --abits_ptr_[-1] == 0)
+	    delete[] (abits_ptr_-1);
+}
+
+inline void vvp_vector4_t::unshare_()
+{
+      if (size_ > BITS_PER_WORD && abits_ptr_[-1] > 1)
+	    unshare_big_();
+}
+
 inline vvp_vector4_t::~vvp_vector4_t()
 {
-      if (size_ > BITS_PER_WORD) {
-	    delete[] abits_ptr_;
-	      // bbits_ptr_ actually points half-way into a
-	      // double-length array started at abits_ptr_
-      }
+      release_words_();
 }
 
 inline vvp_vector4_t& vvp_vector4_t::operator= (const vvp_vector4_t&that)
@@ -424,9 +449,7 @@ inline vvp_vector4_t& vvp_vector4_t::operator= (const vvp_vector4_t&that)
       if (this == &that)
 	    return *this;
 
-      if (size_ > BITS_PER_WORD)
-	    delete[] abits_ptr_;
-
+      release_words_();
       copy_from_(that);
 
       return *this;
@@ -483,6 +506,7 @@ inline void vvp_vector4_t::set_bit(unsigned idx, vvp_bit4_t val)
 
       if (size_ > BITS_PER_WORD) {
 	    unsigned wdx = idx / BITS_PER_WORD;
+	    unshare_();
 	    switch (val) {
 		case BIT4_0:
 		  abits_ptr_[wdx] &= ~mask;
@@ -1078,6 +1102,17 @@ typedef vvp_sub_pointer_t<vvp_net_t> vvp_net_ptr_t;
 template <class T> ostream& operator << (ostream&out, vvp_sub_pointer_t<T> val)
 { out << val.ptr() << "[" << val.port() << "]"; return out; }
 
+/*
+ * The variables that defer their stores (see vvp_net_sig.h) cache a
+ * test of what their fan-out reaches. vvp_net_t::link calls
+ * vvp_coalesce_relink for the net that gets a new destination, so
+ * that only the variables whose fan-out passes through that net redo
+ * the test. The vvp_coalesce_watching flag keeps this out of the way
+ * until some variable has cached a test.
+ */
+extern bool vvp_coalesce_watching;
+extern void vvp_coalesce_relink(vvp_net_t*net);
+
 /*
  * This is the basic unit of netlist connectivity. It is a fan-in of
  * up to 4 inputs, and output pointer, and a pointer to the node's
@@ -1161,6 +1196,11 @@ class vvp_net_t {
     public: // Method to support $countdrivers
       void count_drivers(unsigned idx, unsigned counts[4]);
 
+	// The head of the fan-out list of this net. Following the
+	// port[] links from here visits all the inputs that this net
+	// drives. Sending to it directly bypasses the filter.
+      inline vvp_net_ptr_t fanout() const { return out_; }
+
     private:
       vvp_net_ptr_t out_;
 
@@ -1308,6 +1348,8 @@ class vvp_net_fil_t  : public vvp_vpi_callback {
 	// %release instructions can undo the link as needed. */
       void force_link(vvp_net_t*dst, vvp_net_t*src);
       void force_unlink(void);
+	// True if a %force/link is currently driving this filter.
+      bool force_linked(void) const;
 
       virtual unsigned filter_size() const =0;
 
@@ -1549,6 +1591,9 @@ class vvp_wide_fun_core : public vvp_net_fun_t {
       void* operator new(std::size_t size) { return ::new char[size]; }
       void operator delete(void* ptr) { ::delete[]((char*)ptr); }
 
+	// The net whose output this core drives.
+      vvp_net_t*net() const { return ptr_; }
+
     protected:
       void propagate_vec4(const vvp_vector4_t&bit, vvp_time64_t delay =0);
       void propagate_real(double bit, vvp_time64_t delay =0);
@@ -1597,6 +1642,8 @@ class vvp_wide_fun_t : public vvp_net_fun_t {
 			unsigned base, unsigned wid, unsigned vwid,
                         vvp_context_t context);
 
+      vvp_wide_fun_core*core() const { return core_; }
+
     private:
       vvp_wide_fun_core*core_;
       unsigned port_base_;
@@ -1608,8 +1655,11 @@ inline void vvp_send_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&val, vvp_contex
       while (class vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  if (profile_flag) profile_functor(cur->fun);
 		  cur->fun->recv_vec4(ptr, val, context);
+		  if (profile_flag) profile_functor_done();
+	    }
 
 	    ptr = next;
       }
@@ -1672,8 +1722,11 @@ inline void vvp_send_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&val,
       while (class vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  if (profile_flag) profile_functor(cur->fun);
 		  cur->fun->recv_vec4_pv(ptr, val, base, wid, vwid, context);
+		  if (profile_flag) profile_functor_done();
+	    }
 
 	    ptr = next;
       }
@@ -1685,8 +1738,11 @@ inline void vvp_send_vec8_pv(vvp_net_ptr_t ptr, const vvp_vector8_t&val,
       while (class vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
-	    if (cur->fun)
+	    if (cur->fun) {
+		  if (profile_flag) profile_functor(cur->fun);
 		  cur->fun->recv_vec8_pv(ptr, val, base, wid, vwid);
+		  if (profile_flag) profile_functor_done();
+	    }
 
 	    ptr = next;
       }
@@ -22,11 +22,18 @@
 # include  "vvp_net_sig.h"
 # include  "statistics.h"
 # include  "vpi_priv.h"
+# include  "event.h"
+# include  "udp.h"
+# include  "dff.h"
+# include  "latch.h"
+# include  "vvp_island.h"
 # include  <vector>
+# include  <set>
+# include  <map>
+# include  <algorithm>
 # include  <cassert>
 #ifdef CHECK_WITH_VALGRIND
 # include  <valgrind/memcheck.h>
-# include  <map>
 #endif
 
 # include  <iostream>
@@ -154,6 +161,8 @@ vvp_fun_signal_base::vvp_fun_signal_base()
 vvp_fun_signal4_sa::vvp_fun_signal4_sa(unsigned wid, vvp_bit4_t init)
 : bits4_(wid, init)
 {
+      coalesce_ = COALESCE_UNKNOWN;
+      coalesce_pending_ = false;
 }
 
 /*
@@ -181,7 +190,7 @@ void vvp_fun_signal4_sa::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 			assert(bit.size() == bits4_.size());
 			bits4_ = bit;
 			needs_init_ = false;
-			ptr.ptr()->send_vec4(bits4_, 0);
+			send_value_(ptr.ptr());
 		  }
 	    } else {
 		  bool changed = false;
@@ -194,7 +203,7 @@ void vvp_fun_signal4_sa::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 		  }
 		  if (changed) {
 			needs_init_ = false;
-			ptr.ptr()->send_vec4(bits4_, 0);
+			send_value_(ptr.ptr());
 		  }
 	    }
 	    break;
@@ -236,7 +245,7 @@ void vvp_fun_signal4_sa::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit
 			bits4_.set_bit(base+idx, bit.value(idx));
 		  }
 		  needs_init_ = false;
-		  ptr.ptr()->send_vec4(bits4_,0);
+		  send_value_(ptr.ptr());
 	    } else {
 		  bool changed = false;
 		  assert(bits4_.size() == assign_mask_.size());
@@ -248,7 +257,7 @@ void vvp_fun_signal4_sa::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit
 		  }
 		  if (changed) {
 			needs_init_ = false;
-			ptr.ptr()->send_vec4(bits4_,0);
+			send_value_(ptr.ptr());
 		  }
 	    }
 	    break;
@@ -278,6 +287,205 @@ void vvp_fun_signal4_sa::recv_vec8_pv(vvp_net_ptr_t ptr, const vvp_vector8_t&bit
       recv_vec4_pv(ptr, reduce4(bit), base, wid, vwid, 0);
 }
 
+bool vvp_coalesce_enable = false;
+vector<vvp_net_t*> vvp_coalesce_pending;
+
+unsigned long count_coalesce_stores = 0;
+unsigned long count_coalesce_flushes = 0;
+
+bool vvp_coalesce_watching = false;
+
+/*
+ * For each net that a cached fan-out test passed through, the
+ * variables that cached the test.
+ */
+static map<vvp_net_t*, vector<vvp_net_t*> > coalesce_watch;
+
+/*
+ * Return true if a device that must see every change of its input is
+ * at this node. These are the event functors (anything a thread can
+ * wait on), edge and level sensitive storage (flip-flops, latches and
+ * sequential UDPs), and the ports of tran islands.
+ */
+static bool fanout_observer(vvp_net_fun_t*fun)
+{
+      if (dynamic_cast<waitable_hooks_s*> (fun))
+	    return true;
+      if (dynamic_cast<vvp_dff*> (fun) || dynamic_cast<vvp_latch*> (fun))
+	    return true;
+      if (dynamic_cast<vvp_island_port*> (fun))
+	    return true;
+      if (vvp_wide_fun_t*wide = dynamic_cast<vvp_wide_fun_t*> (fun)) {
+	    vvp_udp_fun_core*udp = dynamic_cast<vvp_udp_fun_core*> (wide->core());
+	    if (udp && udp->is_sequential())
+		  return true;
+      }
+
+      return false;
+}
+
+/*
+ * Return true if an observer is reachable through the fan-out of the
+ * net. Give up and return true if the fan-out cone is larger than the
+ * search limit. The nets of the cone are left in visited.
+ */
+static bool fanout_has_waiters(vvp_net_t*net, set<vvp_net_t*>&visited)
+{
+      const size_t search_limit = 256;
+      vector<vvp_net_t*> work;
+      work.push_back(net);
+      visited.insert(net);
+
+      while (! work.empty()) {
+	    vvp_net_t*cur = work.back();
+	    work.pop_back();
+
+	      // Some nodes pass their input on to another net without
+	      // a link: the input functors of a wide functor, and the
+	      // node of a %force/link.
+	    vvp_net_t*next = 0;
+	    if (vvp_wide_fun_t*wide = dynamic_cast<vvp_wide_fun_t*> (cur->fun))
+		  next = wide->core()->net();
+	    else if (dynamic_cast<vvp_fun_force*> (cur->fun))
+		  next = cur->port[3].ptr();
+
+	    vvp_net_ptr_t ptr = cur->fanout();
+	    for (;;) {
+		  if (next) {
+			if (fanout_observer(next->fun))
+			      return true;
+			if (visited.insert(next).second) {
+			      if (visited.size() > search_limit)
+				    return true;
+			      work.push_back(next);
+			}
+		  }
+
+		  next = ptr.ptr();
+		  if (next == 0)
+			break;
+		  ptr = next->port[ptr.port()];
+	    }
+      }
+
+      return false;
+}
+
+void vvp_coalesce_relink(vvp_net_t*net)
+{
+      map<vvp_net_t*, vector<vvp_net_t*> >::iterator cur = coalesce_watch.find(net);
+      if (cur == coalesce_watch.end())
+	    return;
+
+      vector<vvp_net_t*> vars;
+      vars.swap(cur->second);
+      coalesce_watch.erase(cur);
+
+      for (size_t idx = 0 ; idx < vars.size() ; idx += 1) {
+	    vvp_fun_signal4_sa*fun = static_cast<vvp_fun_signal4_sa*> (vars[idx]->fun);
+	    fun->coalesce_retest();
+      }
+}
+
+void vvp_fun_signal4_sa::send_value_(vvp_net_t*net)
+{
+	// The enable is for the store target only, and not for
+	// anything further along the fan-out.
+      bool enable = vvp_coalesce_enable;
+      vvp_coalesce_enable = false;
+
+      if (enable && coalesce_ == COALESCE_UNKNOWN) {
+	    set<vvp_net_t*> cone;
+	    if (fanout_has_waiters(net, cone)) {
+		  coalesce_ = COALESCE_NO;
+	    } else {
+		  coalesce_ = COALESCE_YES;
+		    // Watch the nets of the cone, so that a link that
+		    // extends the fan-out makes this test again.
+		  for (set<vvp_net_t*>::iterator cur = cone.begin()
+			     ; cur != cone.end() ; ++ cur) {
+			vector<vvp_net_t*>&vars = coalesce_watch[*cur];
+			if (find(vars.begin(), vars.end(), net) == vars.end())
+			      vars.push_back(net);
+		  }
+		  vvp_coalesce_watching = true;
+	    }
+      }
+
+      if (! enable || coalesce_ != COALESCE_YES || net->fil == 0) {
+	    net->send_vec4(bits4_, 0);
+	    return;
+      }
+
+	// Run the filter now so that the signal value and the VPI
+	// callbacks see every change. Only the fan-out is deferred.
+      vvp_vector4_t rep;
+      switch (net->fil->filter_vec4(bits4_, rep, 0, bits4_.size())) {
+	  case vvp_net_fil_t::STOP:
+	    return;
+	  case vvp_net_fil_t::REPL:
+	      // Forced bits are not worth the trouble, so send now,
+	      // but after the stores that are already deferred. If
+	      // this signal is one of them, the flush sends the
+	      // filtered value, which is the replacement.
+	    if (coalesce_pending_) {
+		  vvp_coalesce_flush_list();
+	    } else {
+		  vvp_coalesce_flush();
+		  vvp_send_vec4(net->fanout(), rep, 0);
+	    }
+	    return;
+	  case vvp_net_fil_t::PROP:
+	    break;
+      }
+
+      count_coalesce_stores += 1;
+      if (! coalesce_pending_) {
+	    coalesce_pending_ = true;
+	    vvp_coalesce_pending.push_back(net);
+      }
+}
+
+void vvp_fun_signal4_sa::flush_coalesced(vvp_net_t*net)
+{
+      assert(coalesce_pending_);
+      coalesce_pending_ = false;
+      count_coalesce_flushes += 1;
+
+	// Send the filtered value of the signal, which includes any
+	// force that arrived since the store.
+      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (net->fil);
+      assert(sig);
+      vvp_vector4_t val;
+      sig->vec4_value(val);
+      vvp_send_vec4(net->fanout(), val, 0);
+}
+
+void vvp_coalesce_flush_list(void)
+{
+	// The fan-out may run code that stores to other signals, so
+	// take the list before sending anything.
+      vector<vvp_net_t*> list;
+      list.swap(vvp_coalesce_pending);
+
+      for (size_t idx = 0 ; idx < list.size() ; idx += 1) {
+	    vvp_net_t*net = list[idx];
+	    vvp_fun_signal4_sa*fun = static_cast<vvp_fun_signal4_sa*> (net->fun);
+	    fun->flush_coalesced(net);
+      }
+}
+
+void vvp_coalesce_flush_for_(vvp_net_t*net)
+{
+	// A variable that is not driven from the network is current.
+      if (vvp_fun_signal4_sa*fun = dynamic_cast<vvp_fun_signal4_sa*> (net->fun)) {
+	    if (fun->cassign_link == 0 && ! net->fil->force_linked())
+		  return;
+      }
+
+      vvp_coalesce_flush_list();
+}
+
 void vvp_fun_signal_base::deassign()
 {
       continuous_assign_active_ = false;
@@ -24,6 +24,7 @@
 # include  "vvp_net.h"
 # include  "vvp_object.h"
 # include  <string>
+# include  <vector>
 # include  <cstddef>
 # include  <cstdlib>
 # include  <cstring>
@@ -153,10 +154,62 @@ class vvp_fun_signal4_sa : public vvp_fun_signal_vec {
 	// Get information about the vector value.
       const vvp_vector4_t& vec4_unfiltered_value() const;
 
+	// Send the deferred value of the signal to its fan-out. This
+	// is only called by vvp_coalesce_flush.
+      void flush_coalesced(vvp_net_t*net);
+	// Forget the cached fan-out test. This is only called by
+	// vvp_coalesce_relink.
+      void coalesce_retest() { coalesce_ = COALESCE_UNKNOWN; }
+
+    private:
+      void send_value_(vvp_net_t*net);
+
     private:
       vvp_vector4_t bits4_;
+	// State for deferring the fan-out of procedural stores. See
+	// vvp_coalesce_flush.
+      enum { COALESCE_UNKNOWN, COALESCE_NO, COALESCE_YES };
+      unsigned char coalesce_;
+      bool coalesce_pending_;
 };
 
+/*
+ * A signal may be written many times by one thread before the thread
+ * yields, but only the final value matters to the continuous logic
+ * fed by the signal, since the LRM schedules their evaluation as
+ * separate events. So %store/vec4 sets vvp_coalesce_enable around its
+ * send, and a static vec4 variable whose fan-out reaches no event
+ * functor (so nothing can wait on the intermediate values) updates
+ * its own value and runs its VPI callbacks right away, but only puts
+ * itself on the vvp_coalesce_pending list instead of propagating to
+ * the fan-out. The thread flushes the list before it yields, before
+ * it calls a system task or function, and before it reads a signal
+ * that may be fed by the fan-out. A variable is up to date after each
+ * store, so reading a variable only needs the flush if the variable
+ * is itself driven by a %cassign/link or a %force/link.
+ *
+ * The fan-out test is cached in the variable. When a net that the
+ * test passed through gets a new destination (for example by a
+ * %cassign/link or %force/link), vvp_coalesce_relink makes the
+ * variables that depend on that net test again.
+ */
+extern bool vvp_coalesce_enable;
+extern std::vector<vvp_net_t*> vvp_coalesce_pending;
+extern void vvp_coalesce_flush_list(void);
+extern void vvp_coalesce_flush_for_(vvp_net_t*net);
+
+inline void vvp_coalesce_flush(void)
+{
+      if (! vvp_coalesce_pending.empty())
+	    vvp_coalesce_flush_list();
+}
+
+inline void vvp_coalesce_flush(vvp_net_t*net)
+{
+      if (! vvp_coalesce_pending.empty())
+	    vvp_coalesce_flush_for_(net);
+}
+
 /*
  * Automatically allocated vvp_fun_signal4.
  */